@@ -244,45 +244,34 @@ static void add_attack(int piece, int king, int target) {
 
 bool is_attacked(const board_t * board, int to, int colour) {
 
-   int inc;
-   int pawn;
-   const sq_t * ptr;
-   int from;
-   int piece;
-   int delta;
-   int sq;
+   int to_64;
+   bitboard_t occ, b;
 
    ASSERT(board!=NULL);
    ASSERT(SQUARE_IS_OK(to));
    ASSERT(COLOUR_IS_OK(colour));
 
-   // pawn attack
+   to_64 = SQUARE_TO_64(to);
 
-   inc = PAWN_MOVE_INC(colour);
-   pawn = PAWN_MAKE(colour);
+#ifdef USE_ATTACK_MAP
+   return board->attack_nb[colour][to_64] != 0; // the map is up to date
+#endif
 
-   if (board->square[to-(inc-1)] == pawn) return true;
-   if (board->square[to-(inc+1)] == pawn) return true;
+   // leaper attack (a pawn of "colour" attacks "to" iff an opposite pawn on "to" attacks it)
 
-   // piece attack
+   if ((PawnAttack[COLOUR_OPP(colour)][to_64] & BOARD_BB(board,colour,Pawn6)) != 0) return true;
+   if ((KnightAttack[to_64] & BOARD_BB(board,colour,Knight6)) != 0) return true;
+   if ((KingAttack[to_64] & BOARD_BB(board,colour,King6)) != 0) return true;
 
-   for (ptr = &board->piece[colour][0]; (from=*ptr) != SquareNone; ptr++) {
+   // slider attack
 
-      piece = board->square[from];
-      delta = to - from;
+   occ = BOARD_OCCUPIED(board);
 
-      if (PSEUDO_ATTACK(piece,delta)) {
+   b = board->type_bb[Bishop6] | board->type_bb[Queen6];
+   if ((BISHOP_ATTACK(to_64,occ) & b & board->colour_bb[colour]) != 0) return true;
 
-         inc = DELTA_INC_ALL(delta);
-         ASSERT(inc!=IncNone);
-
-         sq = from;
-         do {
-            sq += inc;
-            if (sq == to) return true;
-         } while (board->square[sq] == Empty);
-      }
-   }
+   b = board->type_bb[Rook6] | board->type_bb[Queen6];
+   if ((ROOK_ATTACK(to_64,occ) & b & board->colour_bb[colour]) != 0) return true;
 
    return false;
 }
@@ -0,0 +1,253 @@
+
+// bench.cpp
+
+// includes
+
+#include "bench.h"
+#include "bitboard.h"
+#include "board.h"
+#include "eval.h"
+#include "fen.h"
+#include "move.h"
+#include "option.h"
+#include "pawn.h"
+#include "piece.h"
+#include "protocol.h"
+#include "search.h"
+#include "trans.h"
+#include "util.h"
+#include "vector.h"
+
+// constants
+
+static const char * const BenchFen[] = {
+
+   // openings and middlegames
+
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+   "r1bqkbnr/pp1ppppp/2n5/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+   "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+   "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+   "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+   "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+   "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+   "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+   "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+   "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+   "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+   "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+   "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+   "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+   "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+   "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+   "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+
+   // endgames
+
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+   "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+   "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+   "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+   "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+   "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+   "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+   "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+   "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+   "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+   "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+   "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+   "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+   "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+   "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+   "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+   "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+   "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+   "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+   "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+   "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+   "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+
+   NULL,
+};
+
+// prototypes
+
+static int mob_ray   (const board_t * board);
+static int mob_table (const board_t * board);
+
+// functions
+
+// bench()
+
+void bench(int depth) {
+
+   int pos;
+   bool own_book;
+   sint64 node_nb;
+   double time;
+   my_timer_t timer[1];
+   char move_string[256];
+
+   ASSERT(depth>=1&&depth<DepthMax);
+
+   node_nb = 0;
+
+   // the book would answer some positions without a search
+
+   own_book = option_get_bool("OwnBook");
+   option_set("OwnBook","false");
+
+   my_timer_reset(timer);
+   my_timer_start(timer);
+
+   for (pos = 0; BenchFen[pos] != NULL; pos++) {
+
+      // start from empty tables so that the node count does not depend on the history
+
+      trans_clear(Trans);
+      pawn_clear();
+      eval_clear();
+
+      search_clear();
+
+      board_from_fen(SearchInput->board,BenchFen[pos]);
+
+      SearchInput->depth_is_limited = true;
+      SearchInput->depth_limit = depth;
+
+      search();
+      search_update_current(Search);
+
+      node_nb += Search->current->total_node_nb;
+
+      if (!move_to_string(Search->best->move,move_string,256)) ASSERT(false);
+      send("info string position %d nodes " S64_FORMAT " bestmove %s",pos+1,Search->current->total_node_nb,move_string);
+   }
+
+   my_timer_stop(timer);
+
+   option_set("OwnBook",(own_book)?"true":"false");
+
+   time = my_timer_elapsed_real(timer);
+
+   send("info string bench: %d positions depth %d",pos,depth);
+   send("info string nodes " S64_FORMAT " time %.0f nps %.0f",node_nb,time*1000.0,(time > 0.0) ? double(node_nb)/time : 0.0);
+}
+
+// bench_attack()
+
+void bench_attack() {
+
+   int pos;
+   int loop;
+   int ray_sum, table_sum;
+   double ray_time, table_time;
+   my_timer_t timer[1];
+   board_t board[1];
+   int (* volatile ray)(const board_t * board); // volatile => calls cannot be hoisted out of the loops
+   int (* volatile table)(const board_t * board);
+
+   // slider mobility of every position, ray walk vs table lookup
+
+   ray = mob_ray;
+   table = mob_table;
+
+   ray_sum = 0;
+   table_sum = 0;
+
+   ray_time = 0.0;
+   table_time = 0.0;
+
+   for (pos = 0; BenchFen[pos] != NULL; pos++) {
+
+      board_from_fen(board,BenchFen[pos]);
+
+      my_timer_reset(timer);
+      my_timer_start(timer);
+      for (loop = 0; loop < BenchAttackLoop; loop++) ray_sum += ray(board);
+      my_timer_stop(timer);
+      ray_time += my_timer_elapsed_real(timer);
+
+      my_timer_reset(timer);
+      my_timer_start(timer);
+      for (loop = 0; loop < BenchAttackLoop; loop++) table_sum += table(board);
+      my_timer_stop(timer);
+      table_time += my_timer_elapsed_real(timer);
+
+      if (mob_ray(board) != mob_table(board)) my_fatal("bench_attack(): mobility mismatch in position %d\n",pos+1);
+   }
+
+   ASSERT(ray_sum==table_sum);
+
+   send("info string bench attack: %d positions %d loops",pos,BenchAttackLoop);
+   send("info string ray %.0f ms table %.0f ms speedup %.2f",ray_time*1000.0,table_time*1000.0,(table_time > 0.0) ? ray_time/table_time : 0.0);
+}
+
+// mob_ray()
+
+static int mob_ray(const board_t * board) {
+
+   int mob;
+   int colour;
+   const sq_t * ptr;
+   int from, to;
+   int piece;
+   const inc_t * inc_ptr;
+   int inc;
+
+   ASSERT(board!=NULL);
+
+   mob = 0;
+
+   for (colour = 0; colour < ColourNb; colour++) {
+      for (ptr = &board->piece[colour][1]; (from=*ptr) != SquareNone; ptr++) { // HACK: no king
+         piece = board->square[from];
+         if (!PIECE_IS_SLIDER(piece)) continue;
+         for (inc_ptr = PIECE_INC(piece); (inc=*inc_ptr) != IncNone; inc_ptr++) {
+            for (to = from+inc; board->square[to] == Empty; to += inc) mob++;
+            if (COLOUR_IS(board->square[to],COLOUR_OPP(colour))) mob++;
+         }
+      }
+   }
+
+   return mob;
+}
+
+// mob_table()
+
+static int mob_table(const board_t * board) {
+
+   int mob;
+   int colour;
+   bitboard_t occ, b;
+   int sq_64;
+
+   ASSERT(board!=NULL);
+
+   mob = 0;
+
+   occ = BOARD_OCCUPIED(board);
+
+   for (colour = 0; colour < ColourNb; colour++) {
+
+      b = BOARD_BB(board,colour,Bishop6) | BOARD_BB(board,colour,Queen6);
+
+      for (; b != 0; BB_REM_FIRST(b)) {
+         sq_64 = BB_FIRST(b);
+         mob += BB_COUNT(BISHOP_ATTACK(sq_64,occ) & ~board->colour_bb[colour]);
+      }
+
+      b = BOARD_BB(board,colour,Rook6) | BOARD_BB(board,colour,Queen6);
+
+      for (; b != 0; BB_REM_FIRST(b)) {
+         sq_64 = BB_FIRST(b);
+         mob += BB_COUNT(ROOK_ATTACK(sq_64,occ) & ~board->colour_bb[colour]);
+      }
+   }
+
+   return mob;
+}
+
+// end of bench.cpp
+
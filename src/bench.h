@@ -0,0 +1,27 @@
+
+// bench.h
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// includes
+
+#include "util.h"
+
+// constants
+
+const int BenchDepth = 8;
+const int BenchHash = 16;
+const int BenchThreads = 1;
+
+const int BenchAttackLoop = 100000;
+
+// functions
+
+extern void bench        (int depth);
+extern void bench_attack ();
+
+#endif // !defined BENCH_H
+
+// end of bench.h
+
@@ -0,0 +1,283 @@
+
+// bitboard.cpp
+
+// includes
+
+#include "bitboard.h"
+#include "colour.h"
+#include "piece.h"
+#include "square.h"
+#include "util.h"
+#include "vector.h"
+
+// constants
+
+static const int BishopTableSize = 0x1480; // sum of 2^bits over the squares
+static const int RookTableSize = 0x19000;
+
+// variables
+
+bitboard_t PawnAttack[ColourNb][64];
+bitboard_t KnightAttack[64];
+bitboard_t KingAttack[64];
+
+magic_t BishopMagic[64];
+magic_t RookMagic[64];
+
+static bitboard_t BishopTable[BishopTableSize];
+static bitboard_t RookTable[RookTableSize];
+
+// prototypes
+
+static bitboard_t leaper_attack (int from, const inc_t inc[]);
+static bitboard_t slider_attack (int from, const inc_t inc[], bitboard_t occ);
+
+static void       magic_init    (magic_t magic[], bitboard_t table[], int table_size, const inc_t inc[]);
+static bitboard_t magic_mask    (int from, const inc_t inc[]);
+
+static uint64     magic_random  (uint64 * seed);
+
+// functions
+
+// bitboard_init()
+
+void bitboard_init() {
+
+   int sq_64, from;
+   int colour;
+   inc_t pawn_inc[2+1];
+
+   // leaper attacks, derived from the 16x16 increments
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      from = SQUARE_FROM_64(sq_64);
+
+      for (colour = 0; colour < ColourNb; colour++) {
+         pawn_inc[0] = PAWN_MOVE_INC(colour) - 1;
+         pawn_inc[1] = PAWN_MOVE_INC(colour) + 1;
+         pawn_inc[2] = IncNone;
+         PawnAttack[colour][sq_64] = leaper_attack(from,pawn_inc);
+      }
+
+      KnightAttack[sq_64] = leaper_attack(from,KnightInc);
+      KingAttack[sq_64] = leaper_attack(from,KingInc);
+   }
+
+   // slider attacks
+
+   magic_init(BishopMagic,BishopTable,BishopTableSize,BishopInc);
+   magic_init(RookMagic,RookTable,RookTableSize,RookInc);
+}
+
+// bb_count()
+
+int bb_count(bitboard_t b) {
+
+   // SWAR population count
+
+   b = b - ((b >> 1) & U64(0x5555555555555555));
+   b = (b & U64(0x3333333333333333)) + ((b >> 2) & U64(0x3333333333333333));
+   b = (b + (b >> 4)) & U64(0x0F0F0F0F0F0F0F0F);
+
+   return int((b * U64(0x0101010101010101)) >> 56);
+}
+
+// bb_first()
+
+int bb_first(bitboard_t b) {
+
+   int sq_64;
+
+   ASSERT(b!=0);
+
+   for (sq_64 = 0; (b & 1) == 0; sq_64++) b >>= 1;
+
+   return sq_64;
+}
+
+// leaper_attack()
+
+static bitboard_t leaper_attack(int from, const inc_t inc[]) {
+
+   bitboard_t b;
+   int i, to;
+
+   ASSERT(SQUARE_IS_OK(from));
+   ASSERT(inc!=NULL);
+
+   b = 0;
+
+   for (i = 0; inc[i] != IncNone; i++) {
+      to = from + inc[i];
+      if (SQUARE_IS_OK(to)) b |= BB_SQUARE(SQUARE_TO_64(to));
+   }
+
+   return b;
+}
+
+// slider_attack()
+
+static bitboard_t slider_attack(int from, const inc_t inc[], bitboard_t occ) {
+
+   bitboard_t b;
+   int i, to;
+
+   ASSERT(SQUARE_IS_OK(from));
+   ASSERT(inc!=NULL);
+
+   // reference ray walk, only used to fill the tables
+
+   b = 0;
+
+   for (i = 0; inc[i] != IncNone; i++) {
+      for (to = from+inc[i]; SQUARE_IS_OK(to); to += inc[i]) {
+         b |= BB_SQUARE(SQUARE_TO_64(to));
+         if ((occ & BB_SQUARE(SQUARE_TO_64(to))) != 0) break;
+      }
+   }
+
+   return b;
+}
+
+// magic_init()
+
+static void magic_init(magic_t magic[], bitboard_t table[], int table_size, const inc_t inc[]) {
+
+   int sq_64, from;
+   int size, offset;
+   int i, n, bits;
+   bitboard_t b;
+   bitboard_t occ[4096], attack[4096];
+   int epoch[4096], try_nb;
+   uint64 index;
+   uint64 seed;
+   magic_t * m;
+
+   ASSERT(magic!=NULL);
+   ASSERT(table!=NULL);
+   ASSERT(inc!=NULL);
+
+   seed = U64(0x9E3779B97F4A7C15); // fixed seed => same tables on every run
+
+   offset = 0;
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      from = SQUARE_FROM_64(sq_64);
+      m = &magic[sq_64];
+
+      m->mask = magic_mask(from,inc);
+      bits = BB_COUNT(m->mask);
+      size = 1 << bits;
+
+      m->shift = 64 - bits;
+      m->attack = &table[offset];
+
+      if (offset + size > table_size) my_fatal("magic_init(): table too small\n");
+
+      // enumerate the occupancy subsets ("carry-rippler")
+
+      n = 0;
+      b = 0;
+
+      do {
+         occ[n] = b;
+         attack[n] = slider_attack(from,inc,b);
+         n++;
+         b = (b - m->mask) & m->mask;
+      } while (b != 0);
+
+      ASSERT(n==size);
+
+#ifdef USE_PEXT
+
+      // the index is the occupancy itself, no magic needed
+
+      m->magic = 0;
+
+      for (i = 0; i < size; i++) {
+         table[offset+_pext_u64(occ[i],m->mask)] = attack[i];
+      }
+
+#else
+
+      // search for a multiplier without destructive collisions
+
+      for (i = 0; i < size; i++) epoch[i] = 0;
+
+      for (try_nb = 1; true; try_nb++) {
+
+         do {
+            m->magic = magic_random(&seed) & magic_random(&seed) & magic_random(&seed); // sparse
+         } while (BB_COUNT((m->mask * m->magic) >> 56) < 6);
+
+         for (i = 0; i < size; i++) {
+
+            index = ((occ[i] & m->mask) * m->magic) >> m->shift;
+
+            if (epoch[index] < try_nb) {
+               epoch[index] = try_nb;
+               table[offset+index] = attack[i];
+            } else if (table[offset+index] != attack[i]) {
+               break; // collision
+            }
+         }
+
+         if (i == size) break; // found
+      }
+
+#endif
+
+      offset += size;
+   }
+
+   ASSERT(offset==table_size);
+}
+
+// magic_mask()
+
+static bitboard_t magic_mask(int from, const inc_t inc[]) {
+
+   bitboard_t b;
+   int i, to;
+
+   ASSERT(SQUARE_IS_OK(from));
+   ASSERT(inc!=NULL);
+
+   // the last square of each ray does not change the attacks
+
+   b = 0;
+
+   for (i = 0; inc[i] != IncNone; i++) {
+      for (to = from+inc[i]; SQUARE_IS_OK(to+inc[i]); to += inc[i]) {
+         b |= BB_SQUARE(SQUARE_TO_64(to));
+      }
+   }
+
+   return b;
+}
+
+// magic_random()
+
+static uint64 magic_random(uint64 * seed) {
+
+   uint64 x;
+
+   ASSERT(seed!=NULL);
+
+   // xorshift64*
+
+   x = *seed;
+
+   x ^= x >> 12;
+   x ^= x << 25;
+   x ^= x >> 27;
+
+   *seed = x;
+
+   return x * U64(0x2545F4914F6CDD1D);
+}
+
+// end of bitboard.cpp
+
@@ -0,0 +1,77 @@
+
+// bitboard.h
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+// includes
+
+#include "colour.h"
+#include "util.h"
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+#ifdef USE_PEXT // BMI2, define on the command line for Haswell and later
+#  include <immintrin.h>
+#endif
+
+// macros
+
+#define BB_SQUARE(sq_64) (U64(1)<<(sq_64))
+
+#if defined(__GNUC__)
+#  define BB_COUNT(b) (__builtin_popcountll(b))
+#  define BB_FIRST(b) (__builtin_ctzll(b))
+#elif defined(_MSC_VER) && defined(_WIN64)
+#  define BB_COUNT(b) (int(__popcnt64(b)))
+#  define BB_FIRST(b) (bb_first(b))
+#else
+#  define BB_COUNT(b) (bb_count(b))
+#  define BB_FIRST(b) (bb_first(b))
+#endif
+
+#define BB_REM_FIRST(b) ((b)&=(b)-1)
+
+#ifdef USE_PEXT
+#  define MAGIC_INDEX(m,occ) (_pext_u64((occ),(m)->mask))
+#else
+#  define MAGIC_INDEX(m,occ) (((((occ)&(m)->mask))*(m)->magic)>>(m)->shift)
+#endif
+
+#define BISHOP_ATTACK(sq_64,occ) (BishopMagic[sq_64].attack[MAGIC_INDEX(&BishopMagic[sq_64],occ)])
+#define ROOK_ATTACK(sq_64,occ)   (RookMagic[sq_64].attack[MAGIC_INDEX(&RookMagic[sq_64],occ)])
+#define QUEEN_ATTACK(sq_64,occ)  (BISHOP_ATTACK(sq_64,occ)|ROOK_ATTACK(sq_64,occ))
+
+// types
+
+typedef uint64 bitboard_t;
+
+struct magic_t {
+   bitboard_t mask; // relevant occupancy, board edges excluded
+   bitboard_t magic;
+   const bitboard_t * attack;
+   int shift;
+};
+
+// variables
+
+extern bitboard_t PawnAttack[ColourNb][64]; // squares attacked by a pawn of that colour
+extern bitboard_t KnightAttack[64];
+extern bitboard_t KingAttack[64];
+
+extern magic_t BishopMagic[64];
+extern magic_t RookMagic[64];
+
+// functions
+
+extern void bitboard_init ();
+
+extern int  bb_count      (bitboard_t b);
+extern int  bb_first      (bitboard_t b);
+
+#endif // !defined BITBOARD_H
+
+// end of bitboard.h
+
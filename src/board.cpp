@@ -3,6 +3,9 @@
 
 // includes
 
+#include <cstddef>
+#include <cstring>
+
 #include "attack.h"
 #include "board.h"
 #include "colour.h"
@@ -24,6 +27,15 @@
 
 static const bool UseSlowDebug = false;
 
+// prototypes
+
+#ifdef USE_ATTACK_MAP
+static bitboard_t piece_attack  (const board_t * board, int sq_64);
+
+static void       attack_set    (board_t * board, int sq_64, int colour, bitboard_t attack);
+static void       attack_update (board_t * board, int sq_64);
+#endif
+
 // functions
 
 // board_is_ok()
@@ -32,6 +44,10 @@ bool board_is_ok(const board_t * board) {
 
    int sq, piece, colour;
    int size, pos;
+#ifdef USE_ATTACK_MAP
+   int sq_64, nb;
+   bitboard_t b;
+#endif
 
    if (board == NULL) return false;
 
@@ -54,10 +70,14 @@ bool board_is_ok(const board_t * board) {
 
             if (pos != -1) return false;
 
+            if ((BOARD_OCCUPIED(board) & BB_SQUARE(SQUARE_TO_64(sq))) != 0) return false;
+
          } else {
 
             if (!piece_is_ok(piece)) return false;
 
+            if ((BOARD_BB(board,PIECE_COLOUR(piece),PIECE_TO_6(piece)) & BB_SQUARE(SQUARE_TO_64(sq))) == 0) return false;
+
             if (!PIECE_IS_PAWN(piece)) {
 
                colour = PIECE_COLOUR(piece);
@@ -138,6 +158,35 @@ bool board_is_ok(const board_t * board) {
       if (board->piece_size[colour] + board->pawn_size[colour] > 16) return false;
    }
 
+   // bitboards
+
+   if ((board->colour_bb[White] & board->colour_bb[Black]) != 0) return false;
+   if (BB_COUNT(BOARD_OCCUPIED(board)) != board->piece_nb) return false;
+
+#ifdef USE_ATTACK_MAP
+
+   // attack maps
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+      if (board->square[SQUARE_FROM_64(sq_64)] == Empty) {
+         if (board->attack_bb[sq_64] != 0) return false;
+      } else {
+         if (board->attack_bb[sq_64] != piece_attack(board,sq_64)) return false;
+      }
+   }
+
+   for (colour = 0; colour < ColourNb; colour++) {
+      for (sq_64 = 0; sq_64 < 64; sq_64++) {
+         nb = 0;
+         for (b = board->colour_bb[colour]; b != 0; BB_REM_FIRST(b)) {
+            if ((board->attack_bb[BB_FIRST(b)] & BB_SQUARE(sq_64)) != 0) nb++;
+         }
+         if (board->attack_nb[colour][sq_64] != nb) return false;
+      }
+   }
+
+#endif
+
    // material
 
    if (board->piece_nb != board->piece_size[White] + board->pawn_size[White]
@@ -155,12 +204,13 @@ bool board_is_ok(const board_t * board) {
    if (!COLOUR_IS_OK(board->turn)) return false;
 
    if (board->ply_nb < 0) return false;
-   if (board->sp < board->ply_nb) return false;
+   if (board->sp < board->ply_nb && board->sp < StackWindow) return false;
+   if (board->sp > StackSize) return false;
 
    if (board->cap_sq != SquareNone && !SQUARE_IS_OK(board->cap_sq)) return false;
 
-   if (board->opening != board_opening(board)) return false;
-   if (board->endgame != board_endgame(board)) return false;
+   if (SCORE_OPENING(board->pst) != board_opening(board)) return false; // scalar reference
+   if (SCORE_ENDGAME(board->pst) != board_endgame(board)) return false;
    if (board->key != hash_key(board)) return false;
    if (board->pawn_key != hash_pawn_key(board)) return false;
    if (board->material_key != hash_material_key(board)) return false;
@@ -201,10 +251,25 @@ void board_clear(board_t * board) {
 
 void board_copy(board_t * dst, const board_t * src) {
 
+   int size;
+
    ASSERT(dst!=NULL);
    ASSERT(board_is_ok(src));
 
-   *dst = *src;
+   // everything but the key stack
+
+   memcpy(dst,src,offsetof(board_t,stack));
+
+   // keys that can still repeat, moved to the bottom of the stack
+
+   size = src->ply_nb;
+   if (size > StackWindow) size = StackWindow;
+   if (size > src->sp) size = src->sp;
+
+   memcpy(&dst->stack[0],&src->stack[src->sp-size],size*sizeof(uint64));
+   dst->sp = size;
+
+   ASSERT(board_is_ok(dst));
 }
 
 // board_init_list()
@@ -217,6 +282,7 @@ void board_init_list(board_t * board) {
    int square;
    int order;
    int file;
+   int type;
 
    ASSERT(board!=NULL);
 
@@ -229,6 +295,21 @@ void board_init_list(board_t * board) {
    board->piece_nb = 0;
    for (piece = 0; piece < 12; piece++) board->number[piece] = 0;
 
+   // bitboards
+
+   for (colour = 0; colour < ColourNb; colour++) board->colour_bb[colour] = 0;
+   for (type = 0; type < TypeNb; type++) board->type_bb[type] = 0;
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+
+      piece = board->square[SQUARE_FROM_64(sq_64)];
+
+      if (piece != Empty && piece_is_ok(piece)) {
+         board->colour_bb[PIECE_COLOUR(piece)] |= BB_SQUARE(sq_64);
+         board->type_bb[PIECE_TO_6(piece)] |= BB_SQUARE(sq_64);
+      }
+   }
+
    // piece lists
 
    for (colour = 0; colour < ColourNb; colour++) {
@@ -339,19 +420,26 @@ void board_init_list(board_t * board) {
       if (board->piece_size[colour] + board->pawn_size[colour] > 16) my_fatal("board_init_list(): illegal position\n");
    }
 
+#ifdef USE_ATTACK_MAP
+
+   // attack maps
+
+   board_attack_init(board);
+
+#endif
+
    // last square
 
    board->cap_sq = SquareNone;
 
    // PST
 
-   board->opening = board_opening(board);
-   board->endgame = board_endgame(board);
+   board->pst = SCORE_MAKE(board_opening(board),board_endgame(board));
 
    // hash key
 
-   for (i = 0; i < board->ply_nb; i++) board->stack[i] = 0; // HACK
-   board->sp = board->ply_nb;
+   board->sp = (board->ply_nb < StackWindow) ? board->ply_nb : StackWindow;
+   for (i = 0; i < board->sp; i++) board->stack[i] = 0; // HACK
 
    board->key = hash_key(board);
    board->pawn_key = hash_pawn_key(board);
@@ -366,6 +454,71 @@ void board_init_list(board_t * board) {
    ASSERT(board_is_ok(board));
 }
 
+#ifdef USE_ATTACK_MAP
+
+// board_attack_init()
+
+void board_attack_init(board_t * board) {
+
+   int colour, sq_64;
+   int piece;
+
+   ASSERT(board!=NULL);
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+      board->attack_bb[sq_64] = 0;
+      for (colour = 0; colour < ColourNb; colour++) board->attack_nb[colour][sq_64] = 0;
+   }
+
+   for (sq_64 = 0; sq_64 < 64; sq_64++) {
+      piece = board->square[SQUARE_FROM_64(sq_64)];
+      if (piece != Empty) attack_set(board,sq_64,PIECE_COLOUR(piece),piece_attack(board,sq_64));
+   }
+}
+
+// board_attack_add()
+
+void board_attack_add(board_t * board, int square) {
+
+   int sq_64;
+   int piece;
+
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(square));
+
+   // called once the piece and the bitboards are in place
+
+   sq_64 = SQUARE_TO_64(square);
+
+   piece = board->square[square];
+   ASSERT(piece_is_ok(piece));
+
+   attack_set(board,sq_64,PIECE_COLOUR(piece),piece_attack(board,sq_64));
+   attack_update(board,sq_64);
+}
+
+// board_attack_remove()
+
+void board_attack_remove(board_t * board, int square, int colour) {
+
+   int sq_64;
+
+   ASSERT(board!=NULL);
+   ASSERT(SQUARE_IS_OK(square));
+   ASSERT(COLOUR_IS_OK(colour));
+
+   // called once the piece and the bitboards have been removed
+
+   ASSERT(board->square[square]==Empty);
+
+   sq_64 = SQUARE_TO_64(square);
+
+   attack_set(board,sq_64,colour,0);
+   attack_update(board,sq_64);
+}
+
+#endif // defined USE_ATTACK_MAP
+
 // board_is_legal()
 
 bool board_is_legal(const board_t * board) {
@@ -512,5 +665,87 @@ int board_endgame(const board_t * board) {
    return endgame;
 }
 
+#ifdef USE_ATTACK_MAP
+
+// piece_attack()
+
+static bitboard_t piece_attack(const board_t * board, int sq_64) {
+
+   int piece;
+   bitboard_t occ;
+
+   ASSERT(board!=NULL);
+   ASSERT(sq_64>=0&&sq_64<64);
+
+   piece = board->square[SQUARE_FROM_64(sq_64)];
+   ASSERT(piece_is_ok(piece));
+
+   occ = BOARD_OCCUPIED(board);
+
+   switch (PIECE_TO_6(piece)) {
+   case Pawn6:   return PawnAttack[PIECE_COLOUR(piece)][sq_64];
+   case Knight6: return KnightAttack[sq_64];
+   case Bishop6: return BISHOP_ATTACK(sq_64,occ);
+   case Rook6:   return ROOK_ATTACK(sq_64,occ);
+   case Queen6:  return QUEEN_ATTACK(sq_64,occ);
+   case King6:   return KingAttack[sq_64];
+   }
+
+   ASSERT(false);
+
+   return 0;
+}
+
+// attack_set()
+
+static void attack_set(board_t * board, int sq_64, int colour, bitboard_t attack) {
+
+   bitboard_t old, b;
+
+   ASSERT(board!=NULL);
+   ASSERT(sq_64>=0&&sq_64<64);
+   ASSERT(COLOUR_IS_OK(colour));
+
+   old = board->attack_bb[sq_64];
+
+   // only the squares that changed are counted
+
+   for (b = old & ~attack; b != 0; BB_REM_FIRST(b)) {
+      ASSERT(board->attack_nb[colour][BB_FIRST(b)]>0);
+      board->attack_nb[colour][BB_FIRST(b)]--;
+   }
+
+   for (b = attack & ~old; b != 0; BB_REM_FIRST(b)) {
+      board->attack_nb[colour][BB_FIRST(b)]++;
+   }
+
+   board->attack_bb[sq_64] = attack;
+}
+
+// attack_update()
+
+static void attack_update(board_t * board, int sq_64) {
+
+   bitboard_t occ, b;
+   int from_64;
+
+   ASSERT(board!=NULL);
+   ASSERT(sq_64>=0&&sq_64<64);
+
+   // sliders whose rays go through the square that changed
+
+   occ = BOARD_OCCUPIED(board);
+
+   b = (BISHOP_ATTACK(sq_64,occ) & (board->type_bb[Bishop6] | board->type_bb[Queen6]))
+     | (ROOK_ATTACK(sq_64,occ) & (board->type_bb[Rook6] | board->type_bb[Queen6]));
+
+   for (; b != 0; BB_REM_FIRST(b)) {
+      from_64 = BB_FIRST(b);
+      attack_set(board,from_64,PIECE_COLOUR(board->square[SQUARE_FROM_64(from_64)]),piece_attack(board,from_64));
+   }
+}
+
+#endif // defined USE_ATTACK_MAP
+
 // end of board.cpp
 
@@ -6,6 +6,7 @@
 
 // includes
 
+#include "bitboard.h"
 #include "colour.h"
 #include "piece.h"
 #include "square.h"
@@ -36,12 +37,22 @@ const int FlagsWhiteQueenCastle = 1 << 1;
 const int FlagsBlackKingCastle  = 1 << 2;
 const int FlagsBlackQueenCastle = 1 << 3;
 
-const int StackSize = 4096;
+const int StackSize = 512; // repetition window + search plies (HeightMax)
+const int StackWindow = 100; // keys board_is_repetition() can reach, see the 50-move rule
 
 // macros
 
 #define KING_POS(board,colour) ((board)->piece[colour][0])
 
+#define BOARD_BB(board,colour,type) ((board)->colour_bb[colour]&(board)->type_bb[type])
+#define BOARD_OCCUPIED(board)       ((board)->colour_bb[White]|(board)->colour_bb[Black])
+
+#ifdef USE_ATTACK_MAP // attack maps updated by move_do(), define on the command line
+#  define BOARD_ATTACK(board,sq_64,attack) ((board)->attack_bb[sq_64])
+#else
+#  define BOARD_ATTACK(board,sq_64,attack) (attack)
+#endif
+
 // types
 
 struct board_t {
@@ -60,6 +71,14 @@ struct board_t {
 
    int pawn_file[ColourNb][FileNb];
 
+   bitboard_t colour_bb[ColourNb]; // indexed by SQUARE_TO_64()
+   bitboard_t type_bb[TypeNb];
+
+#ifdef USE_ATTACK_MAP
+   bitboard_t attack_bb[64]; // squares attacked by the piece on each square
+   uint8 attack_nb[ColourNb][64]; // number of attackers of each colour, pawns and king included
+#endif
+
    int turn;
    int flags;
    int ep_square;
@@ -68,14 +87,13 @@ struct board_t {
 
    int cap_sq;
 
-   int opening;
-   int endgame;
+   int pst; // packed opening/endgame PST sum, see SCORE_MAKE()
 
    uint64 key;
    uint64 pawn_key;
    uint64 material_key;
 
-   uint64 stack[StackSize];
+   uint64 stack[StackSize]; // keep last, board_copy() only copies the live part
 };
 
 // functions
@@ -87,6 +105,12 @@ extern void board_copy          (board_t * dst, const board_t * src);
 
 extern void board_init_list     (board_t * board);
 
+#ifdef USE_ATTACK_MAP
+extern void board_attack_init   (board_t * board);
+extern void board_attack_add    (board_t * board, int square);
+extern void board_attack_remove (board_t * board, int square, int colour);
+#endif
+
 extern bool board_is_legal      (const board_t * board);
 extern bool board_is_check      (const board_t * board);
 extern bool board_is_mate       (const board_t * board);
@@ -3,15 +3,13 @@
 
 // includes
 
-#include <cerrno>
-#include <cstdio>
 #include <cstdlib>
-#include <cstring>
 
 #include "board.h"
 #include "book.h"
 #include "move.h"
 #include "move_gen.h"
+#include "posix.h"
 #include "util.h"
 
 // types
@@ -26,15 +24,16 @@ struct entry_t {
 
 // variables
 
-static FILE * BookFile;
-static int BookSize;
+static const uint8 * BookData; // memory-mapped file
+static uint64 BookDataSize;
+static sint64 BookSize; // number of entries
 
 // prototypes
 
-static int    find_pos     (uint64 key);
+static sint64 find_pos     (uint64 key);
 
-static void   read_entry   (entry_t * entry, int n);
-static uint64 read_integer (FILE * file, int size);
+static void   read_entry   (entry_t * entry, sint64 n);
+static uint64 read_integer (const uint8 * data, int size);
 
 // functions
 
@@ -42,7 +41,8 @@ static uint64 read_integer (FILE * file, int size);
 
 void book_init() {
 
-   BookFile = NULL;
+   BookData = NULL;
+   BookDataSize = 0;
    BookSize = 0;
 }
 
@@ -52,26 +52,22 @@ void book_open(const char file_name[]) {
 
    ASSERT(file_name!=NULL);
 
-   BookFile = fopen(file_name,"rb");
+   // entries are decoded straight from the mapped file, no copy is made
 
-   if (BookFile != NULL) {
+   BookData = (const uint8 *) file_map(file_name,&BookDataSize);
 
-      if (fseek(BookFile,0,SEEK_END) == -1) {
-         my_fatal("book_open(): fseek(): %s\n",strerror(errno));
-      }
-
-      BookSize = ftell(BookFile) / 16;
-      if (BookSize == -1) my_fatal("book_open(): ftell(): %s\n",strerror(errno));
-   }
+   BookSize = (BookData != NULL) ? sint64(BookDataSize / 16) : 0;
 }
 
 // book_close()
 
 void book_close() {
 
-   if (BookFile != NULL && fclose(BookFile) == EOF) {
-      my_fatal("book_close(): fclose(): %s\n",strerror(errno));
-   }
+   if (BookData != NULL) file_unmap(BookData,BookDataSize);
+
+   BookData = NULL;
+   BookDataSize = 0;
+   BookSize = 0;
 }
 
 // book_move()
@@ -80,7 +76,7 @@ int book_move(board_t * board) {
 
    int best_move;
    int best_score;
-   int pos;
+   sint64 pos;
    entry_t entry[1];
    int move;
    int score;
@@ -89,7 +85,7 @@ int book_move(board_t * board) {
 
    ASSERT(board!=NULL);
 
-   if (BookFile != NULL && BookSize != 0) {
+   if (BookData != NULL && BookSize != 0) {
 
       // draw a move according to a fixed probability distribution
 
@@ -130,9 +126,9 @@ int book_move(board_t * board) {
 
 // find_pos()
 
-static int find_pos(uint64 key) {
+static sint64 find_pos(uint64 key) {
 
-   int left, right, mid;
+   sint64 left, right, mid;
    entry_t entry[1];
 
    // binary search (finds the leftmost entry)
@@ -165,51 +161,40 @@ static int find_pos(uint64 key) {
 
 // read_entry()
 
-static void read_entry(entry_t * entry, int n) {
+static void read_entry(entry_t * entry, sint64 n) {
+
+   const uint8 * data;
 
    ASSERT(entry!=NULL);
    ASSERT(n>=0&&n<BookSize);
 
-   ASSERT(BookFile!=NULL);
+   ASSERT(BookData!=NULL);
 
-   if (fseek(BookFile,n*16,SEEK_SET) == -1) {
-      my_fatal("read_entry(): fseek(): %s\n",strerror(errno));
-   }
+   data = &BookData[n*16];
 
-   entry->key   = read_integer(BookFile,8);
-   entry->move  = read_integer(BookFile,2);
-   entry->count = read_integer(BookFile,2);
-   entry->n     = read_integer(BookFile,2);
-   entry->sum   = read_integer(BookFile,2);
+   entry->key   = read_integer(data+0,8);
+   entry->move  = read_integer(data+8,2);
+   entry->count = read_integer(data+10,2);
+   entry->n     = read_integer(data+12,2);
+   entry->sum   = read_integer(data+14,2);
 }
 
 // read_integer()
 
-static uint64 read_integer(FILE * file, int size) {
+static uint64 read_integer(const uint8 * data, int size) {
 
    uint64 n;
    int i;
-   int b;
 
-   ASSERT(file!=NULL);
+   ASSERT(data!=NULL);
    ASSERT(size>0&&size<=8);
 
+   // big-endian
+
    n = 0;
 
    for (i = 0; i < size; i++) {
-
-      b = fgetc(file);
-
-      if (b == EOF) {
-         if (feof(file)) {
-            my_fatal("read_integer(): fgetc(): EOF reached\n");
-         } else { // error
-            my_fatal("read_integer(): fgetc(): %s\n",strerror(errno));
-         }
-      }
-
-      ASSERT(b>=0&&b<256);
-      n = (n << 8) | b;
+      n = (n << 8) | data[i];
    }
 
    return n;
@@ -4,16 +4,19 @@
 // includes
 
 #include <cstdlib> // for abs()
+#include <cstring>
 
 #include "attack.h"
 #include "board.h"
 #include "colour.h"
 #include "eval.h"
+#include "hash.h"
 #include "material.h"
 #include "move.h"
 #include "option.h"
 #include "pawn.h"
 #include "piece.h"
+#include "pst.h"
 #include "see.h"
 #include "util.h"
 #include "value.h"
@@ -23,8 +26,37 @@
 
 #define THROUGH(piece) ((piece)==Empty)
 
+// types
+
+struct eval_entry_t {
+   uint32 lock;
+   sint32 value; // final score, side to move
+};
+
+struct eval_cache_t {
+   eval_entry_t * table;
+   uint32 size;
+   uint32 mask;
+   sint64 read_nb;
+   sint64 read_hit;
+};
+
+// one packed addition, plus the scalar reference in DEBUG mode
+#define SCORE_ADD(colour,op_value,eg_value) {\
+   score[colour] += SCORE_MAKE((op_value),(eg_value));\
+   if (DEBUG) { op[colour] += (op_value); eg[colour] += (eg_value); }\
+}
+
+#define SCORE_MUL_ADD(colour,mul,op_value,eg_value) {\
+   score[colour] += (mul) * SCORE_MAKE((op_value),(eg_value));\
+   if (DEBUG) { op[colour] += (mul) * (op_value); eg[colour] += (mul) * (eg_value); }\
+}
+
 // constants and variables
 
+static const bool UseCache = true;
+static const uint32 CacheSize = 16384; // 128kB
+
 static /* const */ int PieceActivityWeight = 256; // 100%
 static /* const */ int KingSafetyWeight = 256; // 100%
 static /* const */ int PassedPawnWeight = 256; // 100%
@@ -38,6 +70,8 @@ static const int MobMove = 1;
 static const int MobAttack = 1;
 static const int MobDefense = 0;
 
+static const bool UseBitboard = MobMove == 1 && MobAttack == 1 && MobDefense == 0; // table mobility
+
 static const int KnightMobOpening = 4;
 static const int KnightMobEndgame = 4;
 static const int BishopMobOpening = 5;
@@ -98,8 +132,12 @@ static int MobUnit[ColourNb][PieceNb];
 
 static int KingAttackUnit[PieceNb];
 
+static thread_local eval_cache_t Cache[1]; // one table per search thread
+
 // prototypes
 
+static int  eval_comp          (const board_t * board);
+
 static void eval_draw          (const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int mul[2]);
 
 static void eval_piece         (const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int * opening, int * endgame);
@@ -205,10 +243,91 @@ void eval_init() {
    KingAttackUnit[BQ] = 4;
 }
 
+// eval_alloc()
+
+void eval_alloc() {
+
+   ASSERT(sizeof(eval_entry_t)==8);
+
+   if (UseCache) {
+
+      Cache->size = CacheSize;
+      Cache->mask = CacheSize - 1;
+      Cache->table = (eval_entry_t *) my_malloc(Cache->size*sizeof(eval_entry_t));
+
+      eval_clear();
+   }
+}
+
+// eval_free()
+
+void eval_free() {
+
+   if (Cache->table != NULL) my_free(Cache->table);
+
+   Cache->table = NULL;
+   Cache->size = 0;
+   Cache->mask = 0;
+}
+
+// eval_clear()
+
+void eval_clear() {
+
+   if (Cache->table != NULL) {
+      memset(Cache->table,0,Cache->size*sizeof(eval_entry_t));
+   }
+
+   Cache->read_nb = 0;
+   Cache->read_hit = 0;
+}
+
 // eval()
 
 int eval(const board_t * board) {
 
+   uint64 key;
+   eval_entry_t * entry;
+   int value;
+
+   ASSERT(board!=NULL);
+
+   // probe
+
+   if (Cache->table == NULL) return eval_comp(board);
+
+   Cache->read_nb++;
+
+   key = board->key;
+   entry = &Cache->table[KEY_INDEX(key)&Cache->mask];
+
+   if (entry->lock == KEY_LOCK(key)) {
+
+      // found
+
+      Cache->read_hit++;
+
+      ASSERT(entry->value==eval_comp(board));
+
+      return entry->value;
+   }
+
+   // calculation
+
+   value = eval_comp(board);
+
+   // store (always replace)
+
+   entry->lock = KEY_LOCK(key);
+   entry->value = value;
+
+   return value;
+}
+
+// eval_comp()
+
+static int eval_comp(const board_t * board) {
+
    int opening, endgame;
    material_info_t mat_info[1];
    pawn_info_t pawn_info[1];
@@ -239,8 +358,8 @@ int eval(const board_t * board) {
 
    // PST
 
-   opening += board->opening;
-   endgame += board->endgame;
+   opening += SCORE_OPENING(board->pst);
+   endgame += SCORE_ENDGAME(board->pst);
 
    // pawns
 
@@ -553,7 +672,8 @@ static void eval_draw(const board_t * board, const material_info_t * mat_info, c
 static void eval_piece(const board_t * board, const material_info_t * mat_info, const pawn_info_t * pawn_info, int * opening, int * endgame) {
 
    int colour;
-   int op[ColourNb], eg[ColourNb];
+   int score[ColourNb]; // packed
+   int op[ColourNb], eg[ColourNb]; // scalar reference (DEBUG)
    int me, opp;
    int opp_flag;
    const sq_t * ptr;
@@ -565,6 +685,7 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
    int rook_file, king_file;
    int king;
    int delta;
+   bitboard_t occ, attack;
 
    ASSERT(board!=NULL);
    ASSERT(mat_info!=NULL);
@@ -575,12 +696,15 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
    // init
 
    for (colour = 0; colour < ColourNb; colour++) {
+      score[colour] = SCORE_MAKE(0,0);
       op[colour] = 0;
       eg[colour] = 0;
    }
 
    // eval
 
+   occ = BOARD_OCCUPIED(board);
+
    for (colour = 0; colour < ColourNb; colour++) {
 
       me = colour;
@@ -604,17 +728,21 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
 
             mob = -KnightUnit;
 
-            mob += unit[board->square[from-33]];
-            mob += unit[board->square[from-31]];
-            mob += unit[board->square[from-18]];
-            mob += unit[board->square[from-14]];
-            mob += unit[board->square[from+14]];
-            mob += unit[board->square[from+18]];
-            mob += unit[board->square[from+31]];
-            mob += unit[board->square[from+33]];
+            if (UseBitboard) { // empty and enemy squares count 1, own pieces 0
+               attack = BOARD_ATTACK(board,SQUARE_TO_64(from),KnightAttack[SQUARE_TO_64(from)]);
+               mob += BB_COUNT(attack & ~board->colour_bb[me]);
+            } else {
+               mob += unit[board->square[from-33]];
+               mob += unit[board->square[from-31]];
+               mob += unit[board->square[from-18]];
+               mob += unit[board->square[from-14]];
+               mob += unit[board->square[from+14]];
+               mob += unit[board->square[from+18]];
+               mob += unit[board->square[from+31]];
+               mob += unit[board->square[from+33]];
+            }
 
-            op[me] += mob * KnightMobOpening;
-            eg[me] += mob * KnightMobEndgame;
+            SCORE_MUL_ADD(me,mob,KnightMobOpening,KnightMobEndgame);
 
             break;
 
@@ -624,20 +752,25 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
 
             mob = -BishopUnit;
 
-            for (to = from-17; capture=board->square[to], THROUGH(capture); to -= 17) mob += MobMove;
-            mob += unit[capture];
+            if (UseBitboard) {
+               attack = BOARD_ATTACK(board,SQUARE_TO_64(from),BISHOP_ATTACK(SQUARE_TO_64(from),occ));
+               mob += BB_COUNT(attack & ~board->colour_bb[me]);
+            } else {
 
-            for (to = from-15; capture=board->square[to], THROUGH(capture); to -= 15) mob += MobMove;
-            mob += unit[capture];
+               for (to = from-17; capture=board->square[to], THROUGH(capture); to -= 17) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+15; capture=board->square[to], THROUGH(capture); to += 15) mob += MobMove;
-            mob += unit[capture];
+               for (to = from-15; capture=board->square[to], THROUGH(capture); to -= 15) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+17; capture=board->square[to], THROUGH(capture); to += 17) mob += MobMove;
-            mob += unit[capture];
+               for (to = from+15; capture=board->square[to], THROUGH(capture); to += 15) mob += MobMove;
+               mob += unit[capture];
+
+               for (to = from+17; capture=board->square[to], THROUGH(capture); to += 17) mob += MobMove;
+               mob += unit[capture];
+            }
 
-            op[me] += mob * BishopMobOpening;
-            eg[me] += mob * BishopMobEndgame;
+            SCORE_MUL_ADD(me,mob,BishopMobOpening,BishopMobEndgame);
 
             break;
 
@@ -647,38 +780,40 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
 
             mob = -RookUnit;
 
-            for (to = from-16; capture=board->square[to], THROUGH(capture); to -= 16) mob += MobMove;
-            mob += unit[capture];
+            if (UseBitboard) {
+               attack = BOARD_ATTACK(board,SQUARE_TO_64(from),ROOK_ATTACK(SQUARE_TO_64(from),occ));
+               mob += BB_COUNT(attack & ~board->colour_bb[me]);
+            } else {
 
-            for (to = from- 1; capture=board->square[to], THROUGH(capture); to -=  1) mob += MobMove;
-            mob += unit[capture];
+               for (to = from-16; capture=board->square[to], THROUGH(capture); to -= 16) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+ 1; capture=board->square[to], THROUGH(capture); to +=  1) mob += MobMove;
-            mob += unit[capture];
+               for (to = from- 1; capture=board->square[to], THROUGH(capture); to -=  1) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+16; capture=board->square[to], THROUGH(capture); to += 16) mob += MobMove;
-            mob += unit[capture];
+               for (to = from+ 1; capture=board->square[to], THROUGH(capture); to +=  1) mob += MobMove;
+               mob += unit[capture];
 
-            op[me] += mob * RookMobOpening;
-            eg[me] += mob * RookMobEndgame;
+               for (to = from+16; capture=board->square[to], THROUGH(capture); to += 16) mob += MobMove;
+               mob += unit[capture];
+            }
+
+            SCORE_MUL_ADD(me,mob,RookMobOpening,RookMobEndgame);
 
             // open file
 
             if (UseOpenFile) {
 
-               op[me] -= RookOpenFileOpening / 2;
-               eg[me] -= RookOpenFileEndgame / 2;
+               SCORE_ADD(me,-(RookOpenFileOpening / 2),-(RookOpenFileEndgame / 2));
 
                rook_file = SQUARE_FILE(from);
 
                if (board->pawn_file[me][rook_file] == 0) { // no friendly pawn
 
-                  op[me] += RookSemiOpenFileOpening;
-                  eg[me] += RookSemiOpenFileEndgame;
+                  SCORE_ADD(me,RookSemiOpenFileOpening,RookSemiOpenFileEndgame);
 
                   if (board->pawn_file[opp][rook_file] == 0) { // no enemy pawn
-                     op[me] += RookOpenFileOpening - RookSemiOpenFileOpening;
-                     eg[me] += RookOpenFileEndgame - RookSemiOpenFileEndgame;
+                     SCORE_ADD(me,RookOpenFileOpening - RookSemiOpenFileOpening,RookOpenFileEndgame - RookSemiOpenFileEndgame);
                   }
 
                   if ((mat_info->cflags[opp] & MatKingFlag) != 0) {
@@ -689,8 +824,8 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
                      delta = abs(rook_file-king_file); // file distance
 
                      if (delta <= 1) {
-                        op[me] += RookSemiKingFileOpening;
-                        if (delta == 0) op[me] += RookKingFileOpening - RookSemiKingFileOpening;
+                        SCORE_ADD(me,RookSemiKingFileOpening,0);
+                        if (delta == 0) SCORE_ADD(me,RookKingFileOpening-RookSemiKingFileOpening,0);
                      }
                   }
                }
@@ -701,8 +836,7 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
             if (PAWN_RANK(from,me) == Rank7) {
                if ((pawn_info->flags[opp] & BackRankFlag) != 0 // opponent pawn on 7th rank
                 || PAWN_RANK(KING_POS(board,opp),me) == Rank8) {
-                  op[me] += Rook7thOpening;
-                  eg[me] += Rook7thEndgame;
+                  SCORE_ADD(me,Rook7thOpening,Rook7thEndgame);
                }
             }
 
@@ -714,40 +848,44 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
 
             mob = -QueenUnit;
 
-            for (to = from-17; capture=board->square[to], THROUGH(capture); to -= 17) mob += MobMove;
-            mob += unit[capture];
+            if (UseBitboard) {
+               attack = BOARD_ATTACK(board,SQUARE_TO_64(from),QUEEN_ATTACK(SQUARE_TO_64(from),occ));
+               mob += BB_COUNT(attack & ~board->colour_bb[me]);
+            } else {
 
-            for (to = from-16; capture=board->square[to], THROUGH(capture); to -= 16) mob += MobMove;
-            mob += unit[capture];
+               for (to = from-17; capture=board->square[to], THROUGH(capture); to -= 17) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from-15; capture=board->square[to], THROUGH(capture); to -= 15) mob += MobMove;
-            mob += unit[capture];
+               for (to = from-16; capture=board->square[to], THROUGH(capture); to -= 16) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from- 1; capture=board->square[to], THROUGH(capture); to -=  1) mob += MobMove;
-            mob += unit[capture];
+               for (to = from-15; capture=board->square[to], THROUGH(capture); to -= 15) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+ 1; capture=board->square[to], THROUGH(capture); to +=  1) mob += MobMove;
-            mob += unit[capture];
+               for (to = from- 1; capture=board->square[to], THROUGH(capture); to -=  1) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+15; capture=board->square[to], THROUGH(capture); to += 15) mob += MobMove;
-            mob += unit[capture];
+               for (to = from+ 1; capture=board->square[to], THROUGH(capture); to +=  1) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+16; capture=board->square[to], THROUGH(capture); to += 16) mob += MobMove;
-            mob += unit[capture];
+               for (to = from+15; capture=board->square[to], THROUGH(capture); to += 15) mob += MobMove;
+               mob += unit[capture];
 
-            for (to = from+17; capture=board->square[to], THROUGH(capture); to += 17) mob += MobMove;
-            mob += unit[capture];
+               for (to = from+16; capture=board->square[to], THROUGH(capture); to += 16) mob += MobMove;
+               mob += unit[capture];
+
+               for (to = from+17; capture=board->square[to], THROUGH(capture); to += 17) mob += MobMove;
+               mob += unit[capture];
+            }
 
-            op[me] += mob * QueenMobOpening;
-            eg[me] += mob * QueenMobEndgame;
+            SCORE_MUL_ADD(me,mob,QueenMobOpening,QueenMobEndgame);
 
             // 7th rank
 
             if (PAWN_RANK(from,me) == Rank7) {
                if ((pawn_info->flags[opp] & BackRankFlag) != 0 // opponent pawn on 7th rank
                 || PAWN_RANK(KING_POS(board,opp),me) == Rank8) {
-                  op[me] += Queen7thOpening;
-                  eg[me] += Queen7thEndgame;
+                  SCORE_ADD(me,Queen7thOpening,Queen7thEndgame);
                }
             }
 
@@ -758,8 +896,15 @@ static void eval_piece(const board_t * board, const material_info_t * mat_info,
 
    // update
 
-   *opening += ((op[White] - op[Black]) * PieceActivityWeight) / 256;
-   *endgame += ((eg[White] - eg[Black]) * PieceActivityWeight) / 256;
+   if (DEBUG) {
+      for (colour = 0; colour < ColourNb; colour++) {
+         ASSERT(SCORE_OPENING(score[colour])==op[colour]);
+         ASSERT(SCORE_ENDGAME(score[colour])==eg[colour]);
+      }
+   }
+
+   *opening += ((SCORE_OPENING(score[White]) - SCORE_OPENING(score[Black])) * PieceActivityWeight) / 256;
+   *endgame += ((SCORE_ENDGAME(score[White]) - SCORE_ENDGAME(score[Black])) * PieceActivityWeight) / 256;
 }
 
 // eval_king()
@@ -813,7 +958,11 @@ static void eval_king(const board_t * board, const material_info_t * mat_info, i
 
                piece = board->square[from];
 
+#ifdef USE_ATTACK_MAP
+               if ((board->attack_bb[SQUARE_TO_64(from)] & KingAttack[SQUARE_TO_64(king)]) != 0) {
+#else
                if (piece_attack_king(board,piece,from,king)) {
+#endif
                   piece_nb++;
                   attack_tot += KingAttackUnit[piece];
                }
@@ -11,9 +11,13 @@
 
 // functions
 
-extern void eval_init ();
+extern void eval_init  ();
 
-extern int  eval      (const board_t * board);
+extern void eval_alloc ();
+extern void eval_free  ();
+extern void eval_clear ();
+
+extern int  eval       (const board_t * board);
 
 #endif // !defined EVAL_H
 
@@ -0,0 +1,162 @@
+
+// input.cpp
+
+// includes
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "input.h"
+#include "util.h"
+
+// constants
+
+static const int LineNb = 256; // queued lines before the reader waits for the engine
+static const int LineSize = 65536;
+
+// types
+
+struct input_t {
+   std::thread * thread;
+   std::mutex mutex;
+   std::condition_variable cond;
+   const char * line[LineNb];
+   int head;
+   int size;
+   bool eof;
+};
+
+// variables
+
+static input_t Input[1];
+
+static std::atomic<int> Pending; // queued lines (+1 at EOF), polled by the search
+
+// prototypes
+
+static void input_loop ();
+
+// functions
+
+// input_init()
+
+void input_init() {
+
+   int i;
+
+   Input->thread = NULL;
+
+   for (i = 0; i < LineNb; i++) Input->line[i] = NULL;
+
+   Input->head = 0;
+   Input->size = 0;
+   Input->eof = false;
+
+   Pending = 0;
+}
+
+// input_start()
+
+void input_start() {
+
+   ASSERT(Input->thread==NULL);
+
+   Input->thread = new std::thread(input_loop);
+}
+
+// input_end()
+
+void input_end() {
+
+   // the reader exits by itself after "quit" or EOF
+
+   if (Input->thread != NULL) {
+      Input->thread->join();
+      delete Input->thread;
+      Input->thread = NULL;
+   }
+}
+
+// input_available()
+
+bool input_available() {
+
+   // no system call, the search can poll this as often as it likes
+
+   return Pending.load(std::memory_order_relaxed) > 0;
+}
+
+// input_get()
+
+bool input_get(char string[], int size) {
+
+   const char * line;
+
+   ASSERT(string!=NULL);
+   ASSERT(size>=LineSize);
+
+   {
+      std::unique_lock<std::mutex> lock(Input->mutex);
+
+      while (Input->size == 0 && !Input->eof) Input->cond.wait(lock);
+
+      if (Input->size == 0) return false; // EOF
+
+      line = Input->line[Input->head];
+      Input->line[Input->head] = NULL;
+      Input->head = (Input->head + 1) % LineNb;
+      Input->size--;
+
+      Pending--;
+   }
+
+   Input->cond.notify_all();
+
+   strncpy(string,line,size-1);
+   string[size-1] = '\0';
+
+   my_free((void *) line);
+
+   return true;
+}
+
+// input_loop()
+
+static void input_loop() {
+
+   char string[LineSize];
+   bool eof;
+
+   do {
+
+      eof = !my_file_read_line(stdin,string,LineSize);
+
+      {
+         std::unique_lock<std::mutex> lock(Input->mutex);
+
+         if (eof) {
+
+            Input->eof = true;
+
+         } else {
+
+            while (Input->size == LineNb) Input->cond.wait(lock);
+
+            Input->line[(Input->head+Input->size)%LineNb] = my_strdup(string);
+            Input->size++;
+         }
+
+         Pending++;
+      }
+
+      Input->cond.notify_all();
+
+   } while (!eof && strcmp(string,"quit") != 0);
+}
+
+// end of input.cpp
+
@@ -102,6 +102,45 @@ void list_sort(list_t * list) {
    }
 }
 
+// list_select()
+
+void list_select(list_t * list, int pos) {
+
+   int size;
+   int i, best;
+   int move, value;
+
+   ASSERT(list_is_ok(list));
+   ASSERT(pos>=0&&pos<list->size);
+
+   size = list->size;
+   if (size - pos < 2) return; // values are not set for a single move
+
+   // find the first best move in [pos,size[
+
+   best = pos;
+   value = list->value[pos];
+
+   for (i = pos+1; i < size; i++) {
+      if (list->value[i] > value) {
+         best = i;
+         value = list->value[i];
+      }
+   }
+
+   // shift it in place, the others keep their order (same result as list_sort())
+
+   move = list->move[best];
+
+   for (i = best; i > pos; i--) {
+      list->move[i] = list->move[i-1];
+      list->value[i] = list->value[i-1];
+   }
+
+   list->move[pos] = move;
+   list->value[pos] = value;
+}
+
 // list_contain()
 
 bool list_contain(const list_t * list, int move) {
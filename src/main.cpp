@@ -7,14 +7,17 @@
 #include <cstdlib>
 
 #include "attack.h"
+#include "bitboard.h"
 #include "book.h"
 #include "hash.h"
+#include "input.h"
 #include "move_do.h"
 #include "option.h"
 #include "pawn.h"
 #include "piece.h"
 #include "protocol.h"
 #include "random.h"
+#include "smp.h"
 #include "square.h"
 #include "trans.h"
 #include "util.h"
@@ -44,6 +47,7 @@ int main(int argc, char * argv[]) {
    value_init();
    vector_init();
    attack_init();
+   bitboard_init();
    move_do_init();
 
    random_init();
@@ -51,6 +55,15 @@ int main(int argc, char * argv[]) {
 
    trans_init(Trans);
    book_init();
+   smp_init();
+   input_init();
+
+   // command-line bench, "fruit bench [depth] [hash] [threads]"
+
+   if (argc >= 2 && my_string_equal(argv[1],"bench")) {
+      loop_bench(argc,argv);
+      return EXIT_SUCCESS;
+   }
 
    // loop
 
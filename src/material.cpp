@@ -7,7 +7,6 @@
 
 #include "board.h"
 #include "colour.h"
-#include "hash.h"
 #include "material.h"
 #include "option.h"
 #include "piece.h"
@@ -18,7 +17,17 @@
 // constants
 
 static const bool UseTable = true;
-static const uint32 TableSize = 256; // 4kB
+
+// per-side piece counts covered by the table, others are computed on the fly
+
+static const int PawnMax   = 8;
+static const int KnightMax = 2;
+static const int BishopMax = 2;
+static const int RookMax   = 2;
+static const int QueenMax  = 1;
+
+static const int SideSize = (PawnMax + 1) * (KnightMax + 1) * (BishopMax + 1) * (RookMax + 1) * (QueenMax + 1); // 486
+static const int TableSize = SideSize * SideSize; // 236196, 2.7MB
 
 static const int PawnPhase   = 0;
 static const int KnightPhase = 1;
@@ -46,28 +55,16 @@ static const int QueenEndgame  = 1000;
 static const int BishopPairOpening = 50;
 static const int BishopPairEndgame = 50;
 
-// types
-
-typedef material_info_t entry_t;
-
-struct material_t {
-   entry_t * table;
-   uint32 size;
-   uint32 mask;
-   uint32 used;
-   sint64 read_nb;
-   sint64 read_hit;
-   sint64 write_nb;
-   sint64 write_collision;
-};
-
 // variables
 
-static material_t Material[1];
+static material_info_t * Material; // shared and read-only after material_init()
 
 // prototypes
 
-static void material_comp_info (material_info_t * info, const board_t * board);
+static int  side_index         (const int number[], int colour);
+static int  material_index     (const int number[]);
+
+static void material_comp_info (material_info_t * info, const int number[]);
 
 // functions
 
@@ -75,103 +72,144 @@ static void material_comp_info (material_info_t * info, const board_t * board);
 
 void material_init() {
 
+   int number[16];
+   int index, side[ColourNb];
+   int colour;
+   my_timer_t timer[1];
+
+   ASSERT(sizeof(material_info_t)==12);
+
    // UCI options
 
    MaterialWeight = (option_get_int("Material") * 256 + 50) / 100;
 
    // material table
 
-   Material->size = 0;
-   Material->mask = 0;
-   Material->table = NULL;
-}
+   if (!UseTable || Material != NULL) return;
+
+   my_timer_reset(timer);
+   my_timer_start(timer);
+
+   Material = (material_info_t *) my_malloc(TableSize*sizeof(material_info_t));
 
-// material_alloc()
+   for (index = 0; index < 16; index++) number[index] = 0;
 
-void material_alloc() {
+   for (index = 0; index < TableSize; index++) {
 
-   ASSERT(sizeof(entry_t)==16);
+      // decode the per-side counts, inverse of side_index()
 
-   if (UseTable) {
+      side[White] = index / SideSize;
+      side[Black] = index % SideSize;
+
+      for (colour = 0; colour < ColourNb; colour++) {
+         number[WhiteQueen12+colour]  = side[colour] % (QueenMax + 1);  side[colour] /= QueenMax + 1;
+         number[WhiteRook12+colour]   = side[colour] % (RookMax + 1);   side[colour] /= RookMax + 1;
+         number[WhiteBishop12+colour] = side[colour] % (BishopMax + 1); side[colour] /= BishopMax + 1;
+         number[WhiteKnight12+colour] = side[colour] % (KnightMax + 1); side[colour] /= KnightMax + 1;
+         number[WhitePawn12+colour]   = side[colour];
+         ASSERT(number[WhitePawn12+colour]<=PawnMax);
+      }
 
-      Material->size = TableSize;
-      Material->mask = TableSize - 1;
-      Material->table = (entry_t *) my_malloc(Material->size*sizeof(entry_t));
+      ASSERT(material_index(number)==index);
 
-      material_clear();
+      material_comp_info(&Material[index],number);
    }
+
+   my_timer_stop(timer);
+
+   send("info string material table %d entries %dkB %.0f ms",TableSize,int(TableSize*sizeof(material_info_t)/1024),my_timer_elapsed_real(timer)*1000.0);
 }
 
-// material_clear()
+// material_prefetch()
 
-void material_clear() {
+void material_prefetch(const board_t * board) {
 
-   if (Material->table != NULL) {
-      memset(Material->table,0,Material->size*sizeof(entry_t));
-   }
+   int index;
+
+   ASSERT(board!=NULL);
 
-   Material->used = 0;
-   Material->read_nb = 0;
-   Material->read_hit = 0;
-   Material->write_nb = 0;
-   Material->write_collision = 0;
+   if (Material != NULL) {
+      index = material_index(board->number);
+      if (index >= 0) PREFETCH(&Material[index]);
+   }
 }
 
 // material_get_info()
 
 void material_get_info(material_info_t * info, const board_t * board) {
 
-   uint64 key;
-   entry_t * entry;
+   int index;
 
    ASSERT(info!=NULL);
    ASSERT(board!=NULL);
 
-   // probe
-
-   if (UseTable) {
+   // lookup
 
-      Material->read_nb++;
+   if (Material != NULL) {
 
-      key = board->material_key;
-      entry = &Material->table[KEY_INDEX(key)&Material->mask];
+      index = material_index(board->number);
 
-      if (entry->lock == KEY_LOCK(key)) {
+      if (index >= 0) {
 
-         // found
+         *info = Material[index];
 
-         Material->read_hit++;
-
-         *info = *entry;
+#if DEBUG
+         material_info_t check[1];
+         material_comp_info(check,board->number);
+         ASSERT(memcmp(check,info,sizeof(material_info_t))==0);
+#endif
 
          return;
       }
    }
 
-   // calculation
+   // calculation (extra promoted pieces)
+
+   material_comp_info(info,board->number);
+}
 
-   material_comp_info(info,board);
+// side_index()
 
-   // store
+static int side_index(const int number[], int colour) {
 
-   if (UseTable) {
+   int p, n, b, r, q;
 
-      Material->write_nb++;
+   ASSERT(number!=NULL);
+   ASSERT(COLOUR_IS_OK(colour));
 
-      if (entry->lock == 0) { // HACK: assume free entry
-         Material->used++;
-      } else {
-         Material->write_collision++;
-      }
+   p = number[WhitePawn12+colour];
+   n = number[WhiteKnight12+colour];
+   b = number[WhiteBishop12+colour];
+   r = number[WhiteRook12+colour];
+   q = number[WhiteQueen12+colour];
 
-      *entry = *info;
-      entry->lock = KEY_LOCK(key);
-   }
+   if (n > KnightMax || b > BishopMax || r > RookMax || q > QueenMax) return -1;
+
+   ASSERT(p>=0&&p<=PawnMax);
+
+   return (((p * (KnightMax + 1) + n) * (BishopMax + 1) + b) * (RookMax + 1) + r) * (QueenMax + 1) + q;
+}
+
+// material_index()
+
+static int material_index(const int number[]) {
+
+   int white, black;
+
+   ASSERT(number!=NULL);
+
+   white = side_index(number,White);
+   if (white < 0) return -1;
+
+   black = side_index(number,Black);
+   if (black < 0) return -1;
+
+   return white * SideSize + black;
 }
 
 // material_comp_info()
 
-static void material_comp_info(material_info_t * info, const board_t * board) {
+static void material_comp_info(material_info_t * info, const int number[]) {
 
    int wp, wn, wb, wr, wq;
    int bp, bn, bb, br, bq;
@@ -186,21 +224,21 @@ static void material_comp_info(material_info_t * info, const board_t * board) {
    int opening, endgame;
 
    ASSERT(info!=NULL);
-   ASSERT(board!=NULL);
+   ASSERT(number!=NULL);
 
    // init
 
-   wp = board->number[WhitePawn12];
-   wn = board->number[WhiteKnight12];
-   wb = board->number[WhiteBishop12];
-   wr = board->number[WhiteRook12];
-   wq = board->number[WhiteQueen12];
-
-   bp = board->number[BlackPawn12];
-   bn = board->number[BlackKnight12];
-   bb = board->number[BlackBishop12];
-   br = board->number[BlackRook12];
-   bq = board->number[BlackQueen12];
+   wp = number[WhitePawn12];
+   wn = number[WhiteKnight12];
+   wb = number[WhiteBishop12];
+   wr = number[WhiteRook12];
+   wq = number[WhiteQueen12];
+
+   bp = number[BlackPawn12];
+   bn = number[BlackKnight12];
+   bb = number[BlackBishop12];
+   br = number[BlackRook12];
+   bq = number[BlackQueen12];
 
    wt = wq + wr + wb + wn + wp; // no king
    bt = bq + br + bb + bn + bp; // no king
@@ -38,7 +38,6 @@ const int MatKingFlag     = 1 << 3;
 // types
 
 struct material_info_t {
-   uint32 lock;
    uint8 recog;
    uint8 flags;
    uint8 cflags[ColourNb];
@@ -52,9 +51,7 @@ struct material_info_t {
 
 extern void material_init     ();
 
-extern void material_alloc    ();
-extern void material_clear    ();
-
+extern void material_prefetch (const board_t * board);
 extern void material_get_info (material_info_t * info, const board_t * board);
 
 #endif // !defined MATERIAL_H
@@ -3,16 +3,20 @@
 
 // includes
 
+#include <cstring>
+
 #include "attack.h"
 #include "board.h"
 #include "colour.h"
 #include "hash.h"
+#include "material.h"
 #include "move.h"
 #include "move_do.h"
 #include "pawn.h" // TODO: bit.h
 #include "piece.h"
 #include "pst.h"
 #include "random.h"
+#include "trans.h"
 #include "util.h"
 #include "value.h"
 
@@ -26,6 +30,8 @@ static void square_clear (board_t * board, int square, int piece, bool update);
 static void square_set   (board_t * board, int square, int piece, int pos, bool update);
 static void square_move  (board_t * board, int from, int to, int piece, bool update);
 
+static void stack_trim   (board_t * board);
+
 // functions
 
 // move_do_init()
@@ -78,8 +84,7 @@ void move_do(board_t * board, int move, undo_t * undo) {
 
    undo->cap_sq = board->cap_sq;
 
-   undo->opening = board->opening;
-   undo->endgame = board->endgame;
+   undo->pst = board->pst;
 
    undo->key = board->key;
    undo->pawn_key = board->pawn_key;
@@ -98,7 +103,7 @@ void move_do(board_t * board, int move, undo_t * undo) {
 
    // update key stack
 
-   ASSERT(board->sp<StackSize);
+   if (board->sp >= StackSize) stack_trim(board); // long game
    board->stack[board->sp++] = board->key;
 
    // update turn
@@ -211,6 +216,12 @@ void move_do(board_t * board, int move, undo_t * undo) {
       }
    }
 
+   // start fetching the child's hash-table entries
+
+   trans_prefetch(Trans,board->key);
+   if (board->pawn_key != undo->pawn_key) pawn_prefetch(board->pawn_key);
+   if (board->material_key != undo->material_key) material_prefetch(board);
+
    // debug
 
    ASSERT(board_is_ok(board));
@@ -294,8 +305,7 @@ void move_undo(board_t * board, int move, const undo_t * undo) {
 
    board->cap_sq = undo->cap_sq;
 
-   board->opening = undo->opening;
-   board->endgame = undo->endgame;
+   board->pst = undo->pst;
 
    board->key = undo->key;
    board->pawn_key = undo->pawn_key;
@@ -334,7 +344,7 @@ void move_do_null(board_t * board, undo_t * undo) {
 
    // update key stack
 
-   ASSERT(board->sp<StackSize);
+   if (board->sp >= StackSize) stack_trim(board); // long game
    board->stack[board->sp++] = board->key;
 
    // update turn
@@ -358,6 +368,10 @@ void move_do_null(board_t * board, undo_t * undo) {
 
    board->cap_sq = SquareNone;
 
+   // start fetching the child's hash-table entry
+
+   trans_prefetch(Trans,board->key);
+
    // debug
 
    ASSERT(board_is_ok(board));
@@ -399,6 +413,7 @@ static void square_clear(board_t * board, int square, int piece, bool update) {
    int sq;
    int i, size;
    int sq_64;
+   bitboard_t bb;
    uint64 hash_xor;
 
    ASSERT(board!=NULL);
@@ -419,6 +434,22 @@ static void square_clear(board_t * board, int square, int piece, bool update) {
    ASSERT(board->square[square]==piece);
    board->square[square] = Empty;
 
+   // bitboards
+
+   bb = BB_SQUARE(SQUARE_TO_64(square));
+
+   ASSERT((board->colour_bb[colour]&bb)!=0);
+   board->colour_bb[colour] ^= bb;
+   board->type_bb[PIECE_TO_6(piece)] ^= bb;
+
+#ifdef USE_ATTACK_MAP
+
+   // attack maps
+
+   board_attack_remove(board,square,colour);
+
+#endif
+
    // piece list
 
    if (!PIECE_IS_PAWN(piece)) {
@@ -506,8 +537,7 @@ static void square_clear(board_t * board, int square, int piece, bool update) {
 
       // PST
 
-      board->opening -= PST(piece_12,sq_64,Opening);
-      board->endgame -= PST(piece_12,sq_64,Endgame);
+      board->pst -= PST_SCORE(piece_12,sq_64);
 
       // hash key
 
@@ -530,6 +560,7 @@ static void square_set(board_t * board, int square, int piece, int pos, bool upd
    int sq;
    int i, size;
    int sq_64;
+   bitboard_t bb;
    uint64 hash_xor;
 
    ASSERT(board!=NULL);
@@ -548,6 +579,22 @@ static void square_set(board_t * board, int square, int piece, int pos, bool upd
    ASSERT(board->square[square]==Empty);
    board->square[square] = piece;
 
+   // bitboards
+
+   bb = BB_SQUARE(SQUARE_TO_64(square));
+
+   ASSERT((BOARD_OCCUPIED(board)&bb)==0);
+   board->colour_bb[colour] ^= bb;
+   board->type_bb[PIECE_TO_6(piece)] ^= bb;
+
+#ifdef USE_ATTACK_MAP
+
+   // attack maps
+
+   board_attack_add(board,square);
+
+#endif
+
    // piece list
 
    if (!PIECE_IS_PAWN(piece)) {
@@ -639,8 +686,7 @@ static void square_set(board_t * board, int square, int piece, int pos, bool upd
 
       // PST
 
-      board->opening += PST(piece_12,sq_64,Opening);
-      board->endgame += PST(piece_12,sq_64,Endgame);
+      board->pst += PST_SCORE(piece_12,sq_64);
 
       // hash key
 
@@ -664,6 +710,7 @@ static void square_move(board_t * board, int from, int to, int piece, bool updat
    int from_64, to_64;
    int piece_12;
    int piece_index;
+   bitboard_t bb;
    uint64 hash_xor;
 
    ASSERT(board!=NULL);
@@ -695,6 +742,22 @@ static void square_move(board_t * board, int from, int to, int piece, bool updat
    ASSERT(board->pos[to]==-1);
    board->pos[to] = pos;
 
+   // bitboards
+
+   bb = BB_SQUARE(SQUARE_TO_64(from)) ^ BB_SQUARE(SQUARE_TO_64(to));
+
+   board->colour_bb[colour] ^= bb;
+   board->type_bb[PIECE_TO_6(piece)] ^= bb;
+
+#ifdef USE_ATTACK_MAP
+
+   // attack maps
+
+   board_attack_remove(board,from,colour);
+   board_attack_add(board,to);
+
+#endif
+
    // piece list
 
    if (!PIECE_IS_PAWN(piece)) {
@@ -725,8 +788,7 @@ static void square_move(board_t * board, int from, int to, int piece, bool updat
 
       // PST
 
-      board->opening += PST(piece_12,to_64,Opening) - PST(piece_12,from_64,Opening);
-      board->endgame += PST(piece_12,to_64,Endgame) - PST(piece_12,from_64,Endgame);
+      board->pst += PST_SCORE(piece_12,to_64) - PST_SCORE(piece_12,from_64);
 
       // hash key
 
@@ -739,5 +801,18 @@ static void square_move(board_t * board, int from, int to, int piece, bool updat
    }
 }
 
+// stack_trim()
+
+static void stack_trim(board_t * board) {
+
+   ASSERT(board!=NULL);
+   ASSERT(board->sp==StackSize);
+
+   // keep the repetition window only, never happens inside the search (board_copy() rebases)
+
+   memmove(&board->stack[0],&board->stack[board->sp-StackWindow],StackWindow*sizeof(uint64));
+   board->sp = StackWindow;
+}
+
 // end of move_do.cpp
 
@@ -28,8 +28,7 @@ struct undo_t {
 
    int cap_sq;
 
-   int opening;
-   int endgame;
+   int pst;
 
    uint64 key;
    uint64 pawn_key;
@@ -4,6 +4,7 @@
 // includes
 
 #include "attack.h"
+#include "bitboard.h"
 #include "board.h"
 #include "colour.h"
 #include "list.h"
@@ -24,6 +25,8 @@ static void add_promotes            (list_t * list, const board_t * board);
 static void add_en_passant_captures (list_t * list, const board_t * board);
 static void add_castle_moves        (list_t * list, const board_t * board);
 
+static void add_bb_moves            (list_t * list, int from, bitboard_t targets);
+
 // functions
 
 // gen_legal_moves()
@@ -121,6 +124,7 @@ static void add_moves(list_t * list, const board_t * board) {
    int piece, capture;
    const inc_t * inc_ptr;
    int inc;
+   bitboard_t occ, targets;
 
    ASSERT(list!=NULL);
    ASSERT(board!=NULL);
@@ -130,6 +134,9 @@ static void add_moves(list_t * list, const board_t * board) {
 
    opp_flag = COLOUR_FLAG(opp);
 
+   occ = BOARD_OCCUPIED(board);
+   targets = ~board->colour_bb[me];
+
    // piece moves
 
    for (ptr = &board->piece[me][0]; (from=*ptr) != SquareNone; ptr++) {
@@ -139,13 +146,17 @@ static void add_moves(list_t * list, const board_t * board) {
 
       if (PIECE_IS_SLIDER(piece)) {
 
-         for (; (inc=*inc_ptr) != IncNone; inc_ptr++) {
-            for (to = from+inc; (capture=board->square[to]) == Empty; to += inc) {
-               LIST_ADD(list,MOVE_MAKE(from,to));
-            }
-            if (FLAG_IS(capture,opp_flag)) {
-               LIST_ADD(list,MOVE_MAKE(from,to));
-            }
+         switch (PIECE_TYPE(piece)) {
+         case Bishop64:
+            add_bb_moves(list,from,BISHOP_ATTACK(SQUARE_TO_64(from),occ)&targets);
+            break;
+         case Rook64:
+            add_bb_moves(list,from,ROOK_ATTACK(SQUARE_TO_64(from),occ)&targets);
+            break;
+         default:
+            ASSERT(PIECE_IS_QUEEN(piece));
+            add_bb_moves(list,from,QUEEN_ATTACK(SQUARE_TO_64(from),occ)&targets);
+            break;
          }
 
       } else {
@@ -198,7 +209,8 @@ static void add_captures(list_t * list, const board_t * board) {
    int opp_flag;
    const sq_t * ptr;
    int from, to;
-   int piece, capture;
+   int piece;
+   bitboard_t occ, opp_bb;
 
    ASSERT(list!=NULL);
    ASSERT(board!=NULL);
@@ -208,6 +220,9 @@ static void add_captures(list_t * list, const board_t * board) {
 
    opp_flag = COLOUR_FLAG(opp);
 
+   occ = BOARD_OCCUPIED(board);
+   opp_bb = board->colour_bb[opp];
+
    // piece captures
 
    for (ptr = &board->piece[me][0]; (from=*ptr) != SquareNone; ptr++) {
@@ -246,78 +261,17 @@ static void add_captures(list_t * list, const board_t * board) {
 
       case Bishop64:
 
-         for (to = from-17; (capture=board->square[to]) == Empty; to -= 17)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from-15; (capture=board->square[to]) == Empty; to -= 15)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+15; (capture=board->square[to]) == Empty; to += 15)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+17; (capture=board->square[to]) == Empty; to += 17)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
+         add_bb_moves(list,from,BISHOP_ATTACK(SQUARE_TO_64(from),occ)&opp_bb);
          break;
 
       case Rook64:
 
-         for (to = from-16; (capture=board->square[to]) == Empty; to -= 16)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from-1; (capture=board->square[to]) == Empty; to -= 1)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+1; (capture=board->square[to]) == Empty; to += 1)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+16; (capture=board->square[to]) == Empty; to += 16)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
+         add_bb_moves(list,from,ROOK_ATTACK(SQUARE_TO_64(from),occ)&opp_bb);
          break;
 
       case Queen64:
 
-         for (to = from-17; (capture=board->square[to]) == Empty; to -= 17)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from-16; (capture=board->square[to]) == Empty; to -= 16)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from-15; (capture=board->square[to]) == Empty; to -= 15)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from-1; (capture=board->square[to]) == Empty; to -= 1)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+1; (capture=board->square[to]) == Empty; to += 1)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+15; (capture=board->square[to]) == Empty; to += 15)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+16; (capture=board->square[to]) == Empty; to += 16)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
-         for (to = from+17; (capture=board->square[to]) == Empty; to += 17)
-            ;
-         if (FLAG_IS(capture,opp_flag)) LIST_ADD(list,MOVE_MAKE(from,to));
-
+         add_bb_moves(list,from,QUEEN_ATTACK(SQUARE_TO_64(from),occ)&opp_bb);
          break;
 
       case King64:
@@ -407,12 +361,15 @@ static void add_quiet_moves(list_t * list, const board_t * board) {
    const sq_t * ptr;
    int from, to;
    int piece;
+   bitboard_t occ;
 
    ASSERT(list!=NULL);
    ASSERT(board!=NULL);
 
    me = board->turn;
 
+   occ = BOARD_OCCUPIED(board);
+
    // piece moves
 
    for (ptr = &board->piece[me][0]; (from=*ptr) != SquareNone; ptr++) {
@@ -451,78 +408,17 @@ static void add_quiet_moves(list_t * list, const board_t * board) {
 
       case Bishop64:
 
-         for (to = from-17; board->square[to] == Empty; to -= 17) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from-15; board->square[to] == Empty; to -= 15) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+15; board->square[to] == Empty; to += 15) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+17; board->square[to] == Empty; to += 17) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
+         add_bb_moves(list,from,BISHOP_ATTACK(SQUARE_TO_64(from),occ)&~occ);
          break;
 
       case Rook64:
 
-         for (to = from-16; board->square[to] == Empty; to -= 16) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from-1; board->square[to] == Empty; to -= 1) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+1; board->square[to] == Empty; to += 1) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+16; board->square[to] == Empty; to += 16) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
+         add_bb_moves(list,from,ROOK_ATTACK(SQUARE_TO_64(from),occ)&~occ);
          break;
 
       case Queen64:
 
-         for (to = from-17; board->square[to] == Empty; to -= 17) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from-16; board->square[to] == Empty; to -= 16) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from-15; board->square[to] == Empty; to -= 15) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from-1; board->square[to] == Empty; to -= 1) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+1; board->square[to] == Empty; to += 1) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+15; board->square[to] == Empty; to += 15) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+16; board->square[to] == Empty; to += 16) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
-         for (to = from+17; board->square[to] == Empty; to += 17) {
-            LIST_ADD(list,MOVE_MAKE(from,to));
-         }
-
+         add_bb_moves(list,from,QUEEN_ATTACK(SQUARE_TO_64(from),occ)&~occ);
          break;
 
       case King64:
@@ -752,5 +648,17 @@ void add_promote(list_t * list, int move) {
    LIST_ADD(list,move|MovePromoteBishop);
 }
 
+// add_bb_moves()
+
+static void add_bb_moves(list_t * list, int from, bitboard_t targets) {
+
+   ASSERT(list!=NULL);
+   ASSERT(SQUARE_IS_OK(from));
+
+   for (; targets != 0; BB_REM_FIRST(targets)) {
+      LIST_ADD(list,MOVE_MAKE(from,SQUARE_FROM_64(BB_FIRST(targets))));
+   }
+}
+
 // end of move_gen.cpp
 
@@ -24,7 +24,13 @@ struct option_t {
 
 static option_t Option[] = {
 
-   { "Hash", true, "16", "spin", "min 4 max 1024", NULL },
+   { "Hash", true, "16", "spin", "min 4 max 1048576", NULL },
+
+   { "Pawn Hash", true, "1", "spin", "min 1 max 1024", NULL },
+
+   { "Threads", true, "1", "spin", "min 1 max 128", NULL },
+
+   { "MultiPV", true, "1", "spin", "min 1 max 64", NULL },
 
    { "Ponder", true, "false", "check", "", NULL },
 
@@ -36,8 +42,10 @@ static option_t Option[] = {
    { "Verification Search",    true, "Endgame",   "combo", "var Always var Endgame var Never", NULL },
    { "Verification Reduction", true, "5",         "spin",  "min 1 max 6", NULL },
 
-   { "History Pruning",     true, "true", "check", "", NULL },
-   { "History Threshold",   true, "60",   "spin",  "min 0 max 100", NULL },
+   { "Late Move Reductions", true, "true", "check", "", NULL },
+   { "LMR Base",             true, "50",   "spin",  "min 0 max 300", NULL },
+   { "LMR Divisor",          true, "250",  "spin",  "min 50 max 1000", NULL },
+   { "History Threshold",    true, "60",   "spin",  "min 0 max 100", NULL },
 
    { "Futility Pruning", true, "false", "check", "", NULL },
    { "Futility Margin",  true, "100",   "spin",  "min 0 max 500", NULL },
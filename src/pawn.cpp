@@ -11,6 +11,7 @@
 #include "option.h"
 #include "pawn.h"
 #include "piece.h"
+#include "posix.h"
 #include "protocol.h"
 #include "square.h"
 #include "util.h"
@@ -18,7 +19,8 @@
 // constants
 
 static const bool UseTable = true;
-static const uint32 TableSize = 16384; // 256kB
+
+static const int BucketSize = 4; // 64 bytes, one cache line
 
 // types
 
@@ -79,7 +81,7 @@ int BitLast[0x100];
 int BitCount[0x100];
 int BitRev[0x100];
 
-static pawn_t Pawn[1];
+static thread_local pawn_t Pawn[1]; // one table per search thread
 
 static int BitRank1[RankNb];
 static int BitRank2[RankNb];
@@ -183,18 +185,53 @@ void pawn_init() {
 
 void pawn_alloc() {
 
+   uint32 size, target;
+
    ASSERT(sizeof(entry_t)==16);
+   ASSERT(Pawn->table==NULL);
 
    if (UseTable) {
 
-      Pawn->size = TableSize;
-      Pawn->mask = TableSize - 1;
-      Pawn->table = (entry_t *) my_malloc(Pawn->size*sizeof(entry_t));
+      // calculate size
+
+      target = option_get_int("Pawn Hash");
+      if (target < 1) target = 1;
+      if (target > 1024) target = 1024;
+      target *= 1024 * 1024;
+
+      for (size = 1; size != 0 && size <= target; size *= 2)
+         ;
+
+      size /= 2;
+      ASSERT(size>0&&size<=target);
+
+      // allocate table
+
+      size /= sizeof(entry_t);
+      ASSERT(size!=0&&(size&(size-1))==0); // power of 2
+
+      ASSERT(size>=uint32(BucketSize));
+
+      Pawn->size = size;
+      Pawn->mask = size / BucketSize - 1; // buckets do not overlap
+
+      Pawn->table = (entry_t *) large_alloc(Pawn->size*sizeof(entry_t));
 
       pawn_clear();
    }
 }
 
+// pawn_free()
+
+void pawn_free() {
+
+   if (Pawn->table != NULL) large_free(Pawn->table,Pawn->size*sizeof(entry_t));
+
+   Pawn->table = NULL;
+   Pawn->size = 0;
+   Pawn->mask = 0;
+}
+
 // pawn_clear()
 
 void pawn_clear() {
@@ -210,12 +247,42 @@ void pawn_clear() {
    Pawn->write_collision = 0;
 }
 
+// pawn_stats()
+
+void pawn_stats() {
+
+   double hit, collision, full;
+
+   if (Pawn->table == NULL || Pawn->read_nb == 0) return;
+
+   hit = double(Pawn->read_hit) / double(Pawn->read_nb);
+   collision = (Pawn->write_nb != 0) ? double(Pawn->write_collision) / double(Pawn->write_nb) : 0.0;
+   full = double(Pawn->used) / double(Pawn->size);
+
+   send("info string pawn hash %dkB (main thread) probes " S64_FORMAT " hit %.1f%% collision %.1f%% full %.1f%%",int(Pawn->size*sizeof(entry_t)/1024),Pawn->read_nb,hit*100.0,collision*100.0,full*100.0);
+
+   // counters are per search, the entries are kept
+
+   Pawn->read_nb = 0;
+   Pawn->read_hit = 0;
+   Pawn->write_nb = 0;
+   Pawn->write_collision = 0;
+}
+
+// pawn_prefetch()
+
+void pawn_prefetch(uint64 key) {
+
+   if (Pawn->table != NULL) PREFETCH(&Pawn->table[(KEY_INDEX(key)&Pawn->mask)*BucketSize]);
+}
+
 // pawn_get_info()
 
 void pawn_get_info(pawn_info_t * info, const board_t * board) {
 
    uint64 key;
-   entry_t * entry;
+   entry_t * bucket;
+   int i;
 
    ASSERT(info!=NULL);
    ASSERT(board!=NULL);
@@ -227,17 +294,20 @@ void pawn_get_info(pawn_info_t * info, const board_t * board) {
       Pawn->read_nb++;
 
       key = board->pawn_key;
-      entry = &Pawn->table[KEY_INDEX(key)&Pawn->mask];
+      bucket = &Pawn->table[(KEY_INDEX(key)&Pawn->mask)*BucketSize];
 
-      if (entry->lock == KEY_LOCK(key)) {
+      for (i = 0; i < BucketSize; i++) {
 
-         // found
+         if (bucket[i].lock == KEY_LOCK(key)) {
 
-         Pawn->read_hit++;
+            // found
 
-         *info = *entry;
+            Pawn->read_hit++;
 
-         return;
+            *info = bucket[i];
+
+            return;
+         }
       }
    }
 
@@ -251,14 +321,18 @@ void pawn_get_info(pawn_info_t * info, const board_t * board) {
 
       Pawn->write_nb++;
 
-      if (entry->lock == 0) { // HACK: assume free entry
+      if (bucket[BucketSize-1].lock == 0) { // HACK: assume free entry
          Pawn->used++;
       } else {
          Pawn->write_collision++;
       }
 
-      *entry = *info;
-      entry->lock = KEY_LOCK(key);
+      // the newest entry goes first, the oldest one is dropped
+
+      memmove(&bucket[1],&bucket[0],(BucketSize-1)*sizeof(entry_t));
+
+      bucket[0] = *info;
+      bucket[0].lock = KEY_LOCK(key);
    }
 }
 
@@ -0,0 +1,237 @@
+
+// perft.cpp
+
+// includes
+
+#include <atomic>
+#include <thread>
+
+#include "board.h"
+#include "list.h"
+#include "move.h"
+#include "move_do.h"
+#include "move_gen.h"
+#include "option.h"
+#include "perft.h"
+#include "protocol.h"
+#include "smp.h"
+#include "util.h"
+
+// constants
+
+static const bool UseHash = true;
+static const int HashSize = 1 << 20; // 16 MB
+
+// types
+
+struct entry_t {
+   std::atomic<uint64> lock; // key ^ data, see hash_retrieve()
+   std::atomic<uint64> data; // node count (56 bits) and depth (8 bits)
+};
+
+struct perft_t {
+   board_t board[1];
+   list_t list[1];
+   int depth;
+   uint64 node_nb[ListSize];
+   std::atomic<int> next;
+};
+
+// variables
+
+static entry_t * Hash;
+
+// prototypes
+
+static void   perft_loop    (perft_t * perft);
+static uint64 perft_count   (board_t * board, int depth);
+
+static bool   hash_retrieve (uint64 key, int depth, uint64 * node_nb);
+static void   hash_store    (uint64 key, int depth, uint64 node_nb);
+
+// functions
+
+// perft()
+
+void perft(const board_t * board, int depth, bool divide) {
+
+   perft_t perft[1];
+   std::thread * thread[ThreadMax];
+   int thread_nb;
+   int i, id;
+   uint64 node_nb;
+   double time;
+   my_timer_t timer[1];
+   char move_string[256];
+
+   ASSERT(board_is_ok(board));
+
+   if (depth < 1) depth = 1;
+
+   my_timer_reset(timer);
+   my_timer_start(timer);
+
+   // init
+
+   if (UseHash) {
+      Hash = (entry_t *) my_malloc(HashSize*sizeof(entry_t));
+      for (i = 0; i < HashSize; i++) {
+         Hash[i].lock.store(0,std::memory_order_relaxed);
+         Hash[i].data.store(0,std::memory_order_relaxed);
+      }
+   }
+
+   board_copy(perft->board,board);
+   gen_legal_moves(perft->list,perft->board);
+
+   perft->depth = depth;
+
+   for (i = 0; i < LIST_SIZE(perft->list); i++) perft->node_nb[i] = 0;
+   perft->next = 0;
+
+   if (depth == 1) { // nothing to split
+
+      for (i = 0; i < LIST_SIZE(perft->list); i++) perft->node_nb[i] = 1;
+
+   } else {
+
+      // split the root moves among the threads
+
+      thread_nb = option_get_int("Threads");
+      if (thread_nb < 1) thread_nb = 1;
+      if (thread_nb > ThreadMax) thread_nb = ThreadMax;
+
+      for (id = 1; id < thread_nb; id++) thread[id] = new std::thread(perft_loop,perft);
+
+      perft_loop(perft);
+
+      for (id = 1; id < thread_nb; id++) {
+         thread[id]->join();
+         delete thread[id];
+      }
+   }
+
+   if (UseHash) {
+      my_free(Hash);
+      Hash = NULL;
+   }
+
+   // results
+
+   node_nb = 0;
+
+   for (i = 0; i < LIST_SIZE(perft->list); i++) {
+
+      node_nb += perft->node_nb[i];
+
+      if (divide) {
+         if (!move_to_string(LIST_MOVE(perft->list,i),move_string,256)) ASSERT(false);
+         send("%s: " S64_FORMAT,move_string,sint64(perft->node_nb[i]));
+      }
+   }
+
+   my_timer_stop(timer);
+   time = my_timer_elapsed_real(timer);
+
+   send("info string perft depth %d moves %d",depth,LIST_SIZE(perft->list));
+   send("info string nodes " S64_FORMAT " time %.0f nps %.0f",sint64(node_nb),time*1000.0,(time > 0.0) ? double(node_nb)/time : 0.0);
+}
+
+// perft_loop()
+
+static void perft_loop(perft_t * perft) {
+
+   board_t board[1];
+   undo_t undo[1];
+   int i, move;
+
+   ASSERT(perft!=NULL);
+
+   board_copy(board,perft->board);
+
+   // grab the next root move until there are none left
+
+   while ((i = perft->next++) < LIST_SIZE(perft->list)) {
+      move = LIST_MOVE(perft->list,i);
+      move_do(board,move,undo);
+      perft->node_nb[i] = perft_count(board,perft->depth-1);
+      move_undo(board,move,undo);
+   }
+}
+
+// perft_count()
+
+static uint64 perft_count(board_t * board, int depth) {
+
+   list_t list[1];
+   undo_t undo[1];
+   uint64 node_nb;
+   int i, move;
+
+   ASSERT(board!=NULL);
+   ASSERT(depth>=1);
+
+   if (depth >= 2 && UseHash && hash_retrieve(board->key,depth,&node_nb)) return node_nb; // before move generation
+
+   gen_legal_moves(list,board);
+
+   if (depth == 1) return LIST_SIZE(list); // bulk counting
+
+   node_nb = 0;
+
+   for (i = 0; i < LIST_SIZE(list); i++) {
+      move = LIST_MOVE(list,i);
+      move_do(board,move,undo);
+      node_nb += perft_count(board,depth-1);
+      move_undo(board,move,undo);
+   }
+
+   if (UseHash) hash_store(board->key,depth,node_nb);
+
+   return node_nb;
+}
+
+// hash_retrieve()
+
+static bool hash_retrieve(uint64 key, int depth, uint64 * node_nb) {
+
+   entry_t * entry;
+   uint64 lock, data;
+
+   ASSERT(depth>=2&&depth<256);
+   ASSERT(node_nb!=NULL);
+
+   entry = &Hash[key&(HashSize-1)];
+
+   lock = entry->lock.load(std::memory_order_relaxed);
+   data = entry->data.load(std::memory_order_relaxed);
+
+   // a torn entry (two threads writing at once) fails the lock test
+
+   if ((lock ^ data) != key || int(data & 0xFF) != depth) return false;
+
+   *node_nb = data >> 8;
+
+   return true;
+}
+
+// hash_store()
+
+static void hash_store(uint64 key, int depth, uint64 node_nb) {
+
+   entry_t * entry;
+   uint64 data;
+
+   ASSERT(depth>=2&&depth<256);
+   ASSERT(node_nb<(U64(1)<<56));
+
+   entry = &Hash[key&(HashSize-1)];
+
+   data = (node_nb << 8) | uint64(depth);
+
+   entry->lock.store(key^data,std::memory_order_relaxed);
+   entry->data.store(data,std::memory_order_relaxed);
+}
+
+// end of perft.cpp
+
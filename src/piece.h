@@ -58,6 +58,14 @@ const int BlackQueen12  =  9;
 const int WhiteKing12   = 10;
 const int BlackKing12   = 11;
 
+const int Pawn6   = 0; // colourless types, see PIECE_TO_6()
+const int Knight6 = 1;
+const int Bishop6 = 2;
+const int Rook6   = 3;
+const int Queen6  = 4;
+const int King6   = 5;
+const int TypeNb  = 6;
+
 // macros
 
 #define PAWN_MAKE(colour)        (PawnMake[colour])
@@ -75,6 +83,7 @@ const int BlackKing12   = 11;
 #define PIECE_IS_SLIDER(piece)   (((piece)&QueenFlags)!=0)
 
 #define PIECE_TO_12(piece)       (PieceTo12[piece])
+#define PIECE_TO_6(piece)        (PieceTo12[piece]>>1)
 
 #define PIECE_ORDER(piece)       (PieceOrder[piece])
 
@@ -12,8 +12,11 @@
 #if defined(_WIN32) || defined(_WIN64)
 #  include <windows.h>
 #else // assume POSIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
 #  include <sys/resource.h>
 // #  include <sys/select.h>
+#  include <sys/stat.h>
 #  include <sys/time.h>
 #  include <sys/types.h>
 #  include <unistd.h>
@@ -24,7 +27,7 @@
 
 // constants
 
-static const bool UseDebug = false;
+static const size_t HugePageSize = 2 * 1024 * 1024; // x86-64 "large" pages
 
 // prototypes
 
@@ -34,143 +37,241 @@ static double duration (const struct timeval * tv);
 
 // functions
 
-// input_available()
+// now_real()
 
-bool input_available() {
+double now_real() {
 
 #if defined(_WIN32) || defined(_WIN64)
 
-   static bool init = false, is_pipe;
-   static HANDLE stdin_h;
-   DWORD val, error;
+   static double unit = 0.0;
+   LARGE_INTEGER count;
 
-   // val = 0; // needed to make the compiler happy?
+   // GetTickCount() only has a ~16ms resolution, too coarse for search_check()
 
-   // have a look at the "local" buffer first, *this time before init (no idea if it helps)*
+   if (unit == 0.0) {
+      QueryPerformanceFrequency(&count);
+      unit = 1.0 / double(count.QuadPart);
+   }
 
-   if (UseDebug && !init) printf("info string init=%d stdin->_cnt=%d\n",int(init),stdin->_cnt);
+   QueryPerformanceCounter(&count);
 
-   if (stdin->_cnt > 0) return true; // HACK: assumes FILE internals
+   return double(count.QuadPart) * unit;
 
-   // input init (only done once)
+#else // assume POSIX
 
-   if (!init) {
+   struct timeval tv[1];
+   struct timezone tz[1];
 
-      init = true;
+   tz->tz_minuteswest = 0;
+   tz->tz_dsttime = 0; // DST_NONE not declared in linux
 
-      stdin_h = GetStdHandle(STD_INPUT_HANDLE);
+   if (gettimeofday(tv,tz) == -1) { // tz needed at all?
+      my_fatal("now_real(): gettimeofday(): %s\n",strerror(errno));
+   }
 
-      if (UseDebug && (stdin_h == NULL || stdin_h == INVALID_HANDLE_VALUE)) {
-         error = GetLastError();
-         printf("info string GetStdHandle() failed, error=%d\n",error);
-      }
+   return duration(tv);
 
-      is_pipe = !GetConsoleMode(stdin_h,&val); // HACK: assumes pipe on failure
+#endif
+}
 
-      if (UseDebug) printf("info string init=%d is_pipe=%d\n",int(init),int(is_pipe));
+// now_cpu()
 
-      if (UseDebug && is_pipe) { // GetConsoleMode() failed, everybody assumes pipe then
-         error = GetLastError();
-         printf("info string GetConsoleMode() failed, error=%d\n",error);
-      }
+double now_cpu() {
 
-      if (!is_pipe) {
-         SetConsoleMode(stdin_h,val&~(ENABLE_MOUSE_INPUT|ENABLE_WINDOW_INPUT));
-         FlushConsoleInputBuffer(stdin_h); // no idea if we can lose data doing this
-      }
+#if defined(_WIN32) || defined(_WIN64)
+
+   return double(clock()) / double(CLOCKS_PER_SEC); // OK if CLOCKS_PER_SEC is small enough
+
+#else // assume POSIX
+
+   struct rusage ru[1];
+
+   if (getrusage(RUSAGE_SELF,ru) == -1) {
+      my_fatal("now_cpu(): getrusage(): %s\n",strerror(errno));
    }
 
-   // different polling depending on input type
-   // does this code work at all for pipes?
+   return duration(&ru->ru_utime);
 
-   if (is_pipe) {
+#endif
+}
 
-      if (!PeekNamedPipe(stdin_h,NULL,0,NULL,&val,NULL)) {
+// large_alloc()
 
-         if (UseDebug) { // PeekNamedPipe() failed, everybody assumes EOF then
-            error = GetLastError();
-            printf("info string PeekNamedPipe() failed, error=%d\n",error);
-         }
+void * large_alloc(size_t size) {
 
-         return true; // HACK: assumes EOF on failure
-      }
+   void * address;
 
-      if (UseDebug && val < 0) printf("info string PeekNamedPipe(): val=%d\n",val);
+   ASSERT(size>0);
 
-      return val > 0; // != 0???
+#if defined(_WIN32) || defined(_WIN64)
+
+   SIZE_T large;
+
+   // large pages need the "Lock pages in memory" privilege, use normal pages otherwise
 
-   } else {
+   address = NULL;
 
-      GetNumberOfConsoleInputEvents(stdin_h,&val);
-      return val > 1; // no idea why 1
+   large = GetLargePageMinimum();
+
+   if (large != 0 && size % large == 0) {
+      address = VirtualAlloc(NULL,size,MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES,PAGE_READWRITE);
    }
 
-   return false;
+   if (address == NULL) address = VirtualAlloc(NULL,size,MEM_RESERVE|MEM_COMMIT,PAGE_READWRITE);
+
+   if (address == NULL) {
+      my_fatal("large_alloc(): VirtualAlloc(): error=%d\n",int(GetLastError()));
+   }
 
 #else // assume POSIX
 
-   int val;
-   fd_set set[1];
-   struct timeval time_val[1];
+   char * start, * aligned;
+
+   if (size < HugePageSize) {
+
+      // too small for a huge page, rounding up would waste the rest of it
+
+      address = mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+      if (address == MAP_FAILED) my_fatal("large_alloc(): mmap(): %s\n",strerror(errno));
+
+      return address; // page aligned
+   }
+
+   size = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+
+   // explicit huge pages first, only available if reserved by the administrator
+
+   address = MAP_FAILED;
+
+#  ifdef MAP_HUGETLB
+   address = mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+#  endif
+
+   if (address == MAP_FAILED) {
+
+      // normal pages, aligned so that transparent huge pages can back the whole block
+
+      start = (char *) mmap(NULL,size+HugePageSize,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+      if (start == (char *) MAP_FAILED) my_fatal("large_alloc(): mmap(): %s\n",strerror(errno));
+
+      aligned = (char *) ((size_t(start) + HugePageSize - 1) & ~(HugePageSize - 1));
 
-   FD_ZERO(set);
-   FD_SET(STDIN_FILENO,set);
+      if (aligned != start) munmap(start,aligned-start);
+      if (aligned != start + HugePageSize) munmap(aligned+size,start+HugePageSize-aligned);
 
-   time_val->tv_sec = 0;
-   time_val->tv_usec = 0;
+      address = aligned;
 
-   val = select(STDIN_FILENO+1,set,NULL,NULL,time_val);
-   if (val == -1 && errno != EINTR) {
-      my_fatal("input_available(): select(): %s\n",strerror(errno));
+#  ifdef MADV_HUGEPAGE
+      madvise(address,size,MADV_HUGEPAGE); // only a hint, failure is harmless
+#  endif
    }
 
-   return val > 0;
+#endif
+
+   ASSERT(address!=NULL);
+
+   return address;
+}
+
+// large_free()
+
+void large_free(void * address, size_t size) {
+
+   ASSERT(address!=NULL);
+   ASSERT(size>0);
+
+#if defined(_WIN32) || defined(_WIN64)
+
+   VirtualFree(address,0,MEM_RELEASE);
+
+#else // assume POSIX
+
+   if (size >= HugePageSize) size = (size + HugePageSize - 1) & ~(HugePageSize - 1); // see large_alloc()
+
+   if (munmap(address,size) == -1) my_fatal("large_free(): munmap(): %s\n",strerror(errno));
 
 #endif
 }
 
-// now_real()
+// file_map()
 
-double now_real() {
+const void * file_map(const char file_name[], uint64 * size) {
+
+   const void * address;
+
+   ASSERT(file_name!=NULL);
+   ASSERT(size!=NULL);
+
+   // read-only mapping, the pages are shared with other processes
+
+   address = NULL;
+   *size = 0;
 
 #if defined(_WIN32) || defined(_WIN64)
 
-   return double(GetTickCount()) / 1000.0;
+   HANDLE file, map;
+   LARGE_INTEGER file_size;
+
+   file = CreateFile(file_name,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_FLAG_RANDOM_ACCESS,NULL);
+   if (file == INVALID_HANDLE_VALUE) return NULL; // no file
+
+   if (GetFileSizeEx(file,&file_size) && file_size.QuadPart > 0) {
+
+      map = CreateFileMapping(file,NULL,PAGE_READONLY,0,0,NULL);
+
+      if (map != NULL) {
+         address = MapViewOfFile(map,FILE_MAP_READ,0,0,0);
+         CloseHandle(map); // the view keeps the mapping alive
+      }
+
+      if (address == NULL) {
+         my_fatal("file_map(): MapViewOfFile(): error=%d\n",int(GetLastError()));
+      }
+
+      *size = file_size.QuadPart;
+   }
+
+   CloseHandle(file);
 
 #else // assume POSIX
 
-   struct timeval tv[1];
-   struct timezone tz[1];
+   int fd;
+   struct stat st[1];
 
-   tz->tz_minuteswest = 0;
-   tz->tz_dsttime = 0; // DST_NONE not declared in linux
+   fd = open(file_name,O_RDONLY);
+   if (fd == -1) return NULL; // no file
 
-   if (gettimeofday(tv,tz) == -1) { // tz needed at all?
-      my_fatal("now_real(): gettimeofday(): %s\n",strerror(errno));
+   if (fstat(fd,st) == -1) my_fatal("file_map(): fstat(): %s\n",strerror(errno));
+
+   if (st->st_size > 0) {
+
+      address = mmap(NULL,st->st_size,PROT_READ,MAP_SHARED,fd,0);
+      if (address == MAP_FAILED) my_fatal("file_map(): mmap(): %s\n",strerror(errno));
+
+      *size = st->st_size;
    }
 
-   return duration(tv);
+   close(fd); // the mapping keeps the file open
 
 #endif
+
+   return address;
 }
 
-// now_cpu()
+// file_unmap()
 
-double now_cpu() {
+void file_unmap(const void * address, uint64 size) {
+
+   ASSERT(address!=NULL);
+   ASSERT(size>0);
 
 #if defined(_WIN32) || defined(_WIN64)
 
-   return double(clock()) / double(CLOCKS_PER_SEC); // OK if CLOCKS_PER_SEC is small enough
+   UnmapViewOfFile(address);
 
 #else // assume POSIX
 
-   struct rusage ru[1];
-
-   if (getrusage(RUSAGE_SELF,ru) == -1) {
-      my_fatal("now_cpu(): getrusage(): %s\n",strerror(errno));
-   }
-
-   return duration(&ru->ru_utime);
+   if (munmap((void *) address,size) == -1) my_fatal("file_unmap(): munmap(): %s\n",strerror(errno));
 
 #endif
 }
@@ -10,10 +10,14 @@
 
 // functions
 
-extern bool   input_available ();
+extern double       now_real        ();
+extern double       now_cpu         ();
 
-extern double now_real        ();
-extern double now_cpu         ();
+extern void *       large_alloc     (size_t size);
+extern void         large_free      (void * address, size_t size);
+
+extern const void * file_map        (const char file_name[], uint64 * size);
+extern void         file_unmap      (const void * address, uint64 size);
 
 #endif // !defined POSIX_H
 
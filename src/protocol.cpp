@@ -8,20 +8,23 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "bench.h"
 #include "board.h"
 #include "book.h"
 #include "eval.h"
 #include "fen.h"
+#include "input.h"
 #include "material.h"
 #include "move.h"
 #include "move_do.h"
 #include "move_legal.h"
 #include "option.h"
 #include "pawn.h"
-#include "posix.h"
+#include "perft.h"
 #include "protocol.h"
 #include "pst.h"
 #include "search.h"
+#include "smp.h"
 #include "trans.h"
 #include "util.h"
 
@@ -39,12 +42,15 @@ static bool Init;
 static bool Searching; // search in progress?
 static bool Infinite; // infinite or ponder mode?
 static bool Delay; // postpone "bestmove" in infinite/ponder mode?
+static bool Bench; // bench in progress? (input is left alone)
 
 // prototypes
 
+static void loop_init         ();
 static void init              ();
 static void loop_step         ();
 
+static void parse_bench       (char string[]);
 static void parse_go          (char string[]);
 static void parse_position    (char string[]);
 static void parse_setoption   (char string[]);
@@ -60,6 +66,44 @@ static bool string_start_with (const char s1[], const char s2[]);
 
 void loop() {
 
+   loop_init();
+
+   input_start(); // commands are read by their own thread from now on
+
+   while (true) loop_step();
+}
+
+// loop_bench()
+
+void loop_bench(int argc, char * argv[]) {
+
+   char string[256];
+   int i;
+
+   ASSERT(argc>=2);
+   ASSERT(argv!=NULL);
+
+   loop_init();
+
+   // rebuild the "bench" command from the command line
+
+   strcpy(string,"bench");
+
+   for (i = 2; i < argc && i < 5; i++) {
+      if (strlen(string) + strlen(argv[i]) + 2 > sizeof(string)) break;
+      strcat(string," ");
+      strcat(string,argv[i]);
+   }
+
+   parse_bench(string);
+
+   if (Init) smp_free();
+}
+
+// loop_init()
+
+static void loop_init() {
+
    // init (to help debugging)
 
    Init = false;
@@ -67,14 +111,11 @@ void loop() {
    Searching = false;
    Infinite = false;
    Delay = false;
+   Bench = false;
 
    search_clear();
 
    board_from_fen(SearchInput->board,StartFen);
-
-   // loop
-
-   while (true) loop_step();
 }
 
 // init()
@@ -99,10 +140,12 @@ static void init() {
       pawn_alloc();
 
       material_init();
-      material_alloc();
 
       pst_init();
       eval_init();
+      eval_alloc();
+
+      smp_alloc();
    }
 }
 
@@ -110,7 +153,7 @@ static void init() {
 
 void event() {
 
-   while (!SearchInfo->stop && input_available()) loop_step();
+   while (!Bench && !Search->info->stop && input_available()) loop_step();
 }
 
 // loop_step()
@@ -127,10 +170,26 @@ static void loop_step() {
 
    if (false) {
 
+   } else if (string_equal(string,"bench") || string_start_with(string,"bench ")) {
+
+      if (!Searching && !Delay) {
+         parse_bench(string);
+      } else {
+         ASSERT(false);
+      }
+
    } else if (string_start_with(string,"debug ")) {
 
       // dummy
 
+   } else if (string_start_with(string,"divide ")) {
+
+      if (!Searching && !Delay) {
+         perft(SearchInput->board,atoi(string+7),true);
+      } else {
+         ASSERT(false);
+      }
+
    } else if (string_start_with(string,"go ")) {
 
       if (!Searching && !Delay) {
@@ -167,6 +226,14 @@ static void loop_step() {
          ASSERT(false);
       }
 
+   } else if (string_start_with(string,"perft ")) {
+
+      if (!Searching && !Delay) {
+         perft(SearchInput->board,atoi(string+6),false);
+      } else {
+         ASSERT(false);
+      }
+
    } else if (string_start_with(string,"position ")) {
 
       if (!Searching && !Delay) {
@@ -181,6 +248,9 @@ static void loop_step() {
       ASSERT(!Searching);
       ASSERT(!Delay);
 
+      if (Init) smp_free();
+      input_end();
+
       exit(EXIT_SUCCESS);
 
    } else if (string_start_with(string,"setoption ")) {
@@ -195,7 +265,7 @@ static void loop_step() {
 
       if (Searching) {
 
-         SearchInfo->stop = true;
+         Search->info->stop = true;
          Infinite = false;
 
       } else if (Delay) {
@@ -226,6 +296,100 @@ static void loop_step() {
    }
 }
 
+// parse_bench()
+
+static void parse_bench(char string[]) {
+
+   const char * ptr;
+   int depth, hash, thread_nb;
+   int old_hash, old_thread_nb;
+   char value[256];
+   board_t board[1];
+
+   // init
+
+   depth = BenchDepth;
+   hash = BenchHash;
+   thread_nb = BenchThreads;
+
+   // parse "bench [depth] [hash] [threads]" or "bench attack"
+
+   ptr = strtok(string," "); // skip "bench"
+
+   ptr = strtok(NULL," ");
+
+   if (ptr != NULL && string_equal(ptr,"attack")) {
+      bench_attack(); // no search, tables are not needed
+      return;
+   }
+
+   if (ptr != NULL) depth = atoi(ptr);
+
+   ptr = (ptr != NULL) ? strtok(NULL," ") : NULL;
+   if (ptr != NULL) hash = atoi(ptr);
+
+   ptr = (ptr != NULL) ? strtok(NULL," ") : NULL;
+   if (ptr != NULL) thread_nb = atoi(ptr);
+
+   if (depth < 1 || depth >= DepthMax) depth = BenchDepth;
+   if (hash < 4) hash = BenchHash;
+   if (thread_nb < 1 || thread_nb > ThreadMax) thread_nb = BenchThreads;
+
+   // save the GUI's settings and position
+
+   old_hash = option_get_int("Hash");
+   old_thread_nb = option_get_int("Threads");
+
+   board_copy(board,SearchInput->board);
+
+   // update options
+
+   sprintf(value,"%d",hash);
+   option_set("Hash",value);
+
+   sprintf(value,"%d",thread_nb);
+   option_set("Threads",value);
+
+   if (Init) { // Init => already allocated
+      trans_free(Trans);
+      trans_alloc(Trans);
+      smp_free();
+      smp_alloc();
+   } else {
+      init();
+   }
+
+   // bench
+
+   ASSERT(!Bench);
+   Bench = true;
+
+   bench(depth);
+
+   Bench = false;
+
+   // restore the GUI's settings and position
+
+   sprintf(value,"%d",old_hash);
+   option_set("Hash",value);
+
+   sprintf(value,"%d",old_thread_nb);
+   option_set("Threads",value);
+
+   if (hash != old_hash) {
+      trans_free(Trans);
+      trans_alloc(Trans);
+   }
+
+   if (thread_nb != old_thread_nb) {
+      smp_free();
+      smp_alloc();
+   }
+
+   search_clear();
+   board_copy(SearchInput->board,board);
+}
+
 // parse_go()
 
 static void parse_go(char string[]) {
@@ -363,6 +527,13 @@ static void parse_go(char string[]) {
       SearchInput->depth_limit = mate * 2 - 1; // HACK: move -> ply
    }
 
+   // node limit
+
+   if (nodes >= 0) {
+      SearchInput->node_is_limited = true;
+      SearchInput->node_limit = nodes;
+   }
+
    // time limit
 
    if (COLOUR_IS_WHITE(SearchInput->board->turn)) {
@@ -416,7 +587,7 @@ static void parse_go(char string[]) {
    Delay = false;
 
    search();
-   search_update_current();
+   search_update_current(Search);
 
    ASSERT(Searching);
    ASSERT(!Delay);
@@ -523,6 +694,29 @@ static void parse_setoption(char string[]) {
          trans_alloc(Trans);
       }
    }
+
+   // update pawn-table size if needed, the helpers reallocate theirs on restart
+
+   if (Init && my_string_equal(name,"Pawn Hash")) { // Init => already allocated
+
+      ASSERT(!Searching);
+
+      pawn_free();
+      pawn_alloc();
+
+      smp_free();
+      smp_alloc();
+   }
+
+   // update the number of search threads if needed
+
+   if (Init && my_string_equal(name,"Threads")) { // Init => already started
+
+      ASSERT(!Searching);
+
+      smp_free();
+      smp_alloc();
+   }
 }
 
 // send_best_move()
@@ -540,21 +734,20 @@ static void send_best_move() {
 
    // HACK: should be in search.cpp
 
-   time = SearchCurrent->time;
-   speed = SearchCurrent->speed;
-   cpu = SearchCurrent->cpu;
-   node_nb = SearchCurrent->node_nb;
+   time = Search->current->time;
+   speed = Search->current->speed;
+   cpu = Search->current->cpu;
+   node_nb = Search->current->total_node_nb;
 
    send("info time %.0f nodes " S64_FORMAT " nps %.0f cpuload %.0f",time*1000.0,node_nb,speed,cpu*1000.0);
 
    trans_stats(Trans);
-   // pawn_stats();
-   // material_stats();
+   pawn_stats();
 
    // best move
 
-   move = SearchBest->move;
-   pv = SearchBest->pv;
+   move = Search->best->move;
+   pv = Search->best->pv;
 
    move_to_string(move,move_string,256);
 
@@ -573,7 +766,9 @@ void get(char string[], int size) {
    ASSERT(string!=NULL);
    ASSERT(size>=65536);
 
-   if (!my_file_read_line(stdin,string,size)) { // EOF
+   if (!input_get(string,size)) { // EOF
+      if (Init) smp_free();
+      input_end();
       exit(EXIT_SUCCESS);
    }
 }
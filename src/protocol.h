@@ -10,11 +10,12 @@
 
 // functions
 
-extern void loop  ();
-extern void event ();
+extern void loop       ();
+extern void loop_bench (int argc, char * argv[]);
+extern void event      ();
 
-extern void get   (char string[], int size);
-extern void send  (const char format[], ...);
+extern void get        (char string[], int size);
+extern void send       (const char format[], ...);
 
 #endif // !defined PROTOCOL_H
 
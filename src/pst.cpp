@@ -88,6 +88,7 @@ static const int KingRank[8] = {
 // variables
 
 sint16 Pst[12][64][StageNb];
+sint32 PstScore[12][64];
 
 // prototypes
 
@@ -303,6 +304,16 @@ void pst_init() {
          }
       }
    }
+
+   // packed copy for move_do()
+
+   for (piece = 0; piece < 12; piece++) {
+      for (sq = 0; sq < 64; sq++) {
+         PstScore[piece][sq] = SCORE_MAKE(P(piece,sq,Opening),P(piece,sq,Endgame));
+         ASSERT(SCORE_OPENING(PstScore[piece][sq])==P(piece,sq,Opening));
+         ASSERT(SCORE_ENDGAME(PstScore[piece][sq])==P(piece,sq,Endgame));
+      }
+   }
 }
 
 // square_make()
@@ -17,10 +17,19 @@ const int StageNb = 2;
 // macros
 
 #define PST(piece_12,square_64,stage) (Pst[piece_12][square_64][stage])
+#define PST_SCORE(piece_12,square_64)  (PstScore[piece_12][square_64])
+
+// packed scores, opening in the low 16 bits and endgame in the high 16 bits (both signed)
+// sums and multiplications by an integer stay exact as long as each half fits 16 bits
+
+#define SCORE_MAKE(opening,endgame) ((int)(((unsigned)(endgame)<<16)+(unsigned)(opening)))
+#define SCORE_OPENING(score)        ((int)(sint16)(uint16)(unsigned)(score))
+#define SCORE_ENDGAME(score)        ((int)(sint16)(uint16)(((unsigned)(score)+0x8000)>>16))
 
 // variables
 
 extern sint16 Pst[12][64][StageNb];
+extern sint32 PstScore[12][64];
 
 // functions
 
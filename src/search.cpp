@@ -3,7 +3,7 @@
 
 // includes
 
-#include <csetjmp>
+#include <atomic>
 
 #include "attack.h"
 #include "board.h"
@@ -16,10 +16,12 @@
 #include "move_gen.h"
 #include "option.h"
 #include "pawn.h"
+#include "posix.h"
 #include "protocol.h"
 #include "pv.h"
 #include "search.h"
 #include "search_full.h"
+#include "smp.h"
 #include "sort.h"
 #include "trans.h"
 #include "util.h"
@@ -30,12 +32,17 @@
 static const bool UseCpuTime = false; // false
 static const bool UseEvent = true; // true
 
+static const bool UseCheckTime = true; // poll at a fixed rate whatever the speed
+static const double CheckTime = 0.005; // seconds between two search_check() calls
+static const int CheckIncMin = 1000;
+static const int CheckIncMax = 100000;
+
 #ifdef SHORT_SEARCH_OPTION
 static const bool UseShortSearch = false;
 static const int ShortSearchDepth = 2;
 #endif
 
-static constexpr bool DispBest = false; // true
+static constexpr bool DispBest = true; // true
 static constexpr bool DispDepthStart = false; // true
 static constexpr bool DispDepthEnd = false; // true
 static constexpr bool DispRoot = false; // true
@@ -55,14 +62,23 @@ static const bool UseExtension = true;
 // variables
 
 search_input_t SearchInput[1];
-search_info_t SearchInfo[1];
-search_root_t SearchRoot[1];
-search_current_t SearchCurrent[1];
-search_best_t SearchBest[1];
+search_t Search[1];
+
+static search_best_t SmpBest[ThreadMax]; // helper results, read after smp_stop()
+static std::atomic<sint64> SmpNodeNb[ThreadMax];
 
 // prototypes
 
-static void search_send_stat ();
+static void search_clear_thread (search_t * search);
+static void search_init_check   (search_t * search);
+static void search_clip_check   (search_t * search, sint64 node_nb);
+static void search_adapt_check  (search_t * search);
+
+static void search_smp_start    ();
+static void search_smp_end      ();
+
+static void search_send_stat    (search_t * search);
+static void search_send_lines   ();
 
 // functions
 
@@ -92,42 +108,111 @@ void search_clear() {
    SearchInput->time_is_limited = false;
    SearchInput->time_limit_1 = 0.0;
    SearchInput->time_limit_2 = 0.0;
+   SearchInput->node_is_limited = false;
+   SearchInput->node_limit = 0;
+   SearchInput->multipv = 1;
+
+   // main thread
 
-   // SearchInfo
-
-   SearchInfo->can_stop = false;
-   SearchInfo->stop = false;
-   SearchInfo->check_nb = 10000; // was 100000
-   SearchInfo->check_inc = 10000; // was 100000
-   SearchInfo->last_time = 0.0;
-
-   // SearchBest
-
-   SearchBest->move = MoveNone;
-   SearchBest->value = 0;
-   SearchBest->flags = SearchUnknown;
-   PV_CLEAR(SearchBest->pv);
-
-   // SearchRoot
-
-   SearchRoot->depth = 0;
-   SearchRoot->move = MoveNone;
-   SearchRoot->move_pos = 0;
-   SearchRoot->move_nb = 0;
-   SearchRoot->last_value = 0;
-   SearchRoot->bad_1 = false;
-   SearchRoot->bad_2 = false;
-   SearchRoot->change = false;
-   SearchRoot->easy = false;
-   SearchRoot->flag = false;
-
-   // SearchCurrent
-
-   SearchCurrent->max_depth = 0;
-   SearchCurrent->node_nb = 0;
-   SearchCurrent->time = 0.0;
-   SearchCurrent->speed = 0.0;
-   SearchCurrent->cpu = 0.0;
+   Search->input = SearchInput;
+   search_clear_thread(Search);
+}
+
+// search_clear_thread()
+
+static void search_clear_thread(search_t * search) {
+
+   ASSERT(search!=NULL);
+
+   // info
+
+   search->info->id = 0;
+   search->info->can_stop = false;
+   search->info->stop = false;
+   search->info->stopped = false;
+   search->info->check_nb = 10000; // was 100000
+   search->info->check_inc = 10000; // was 100000
+   search->info->check_time = 0.0;
+   search->info->last_time = 0.0;
+
+   // best
+
+   search->best->move = MoveNone;
+   search->best->value = 0;
+   search->best->flags = SearchUnknown;
+   search->best->depth = 0;
+   PV_CLEAR(search->best->pv);
+
+   // root
+
+   search->root->depth = 0;
+   search->root->move = MoveNone;
+   search->root->move_pos = 0;
+   search->root->move_nb = 0;
+   search->root->last_value = 0;
+   search->root->bad_1 = false;
+   search->root->bad_2 = false;
+   search->root->change = false;
+   search->root->easy = false;
+   search->root->flag = false;
+   search->root->line_nb = 0;
+
+   // current
+
+   search->current->max_depth = 0;
+   search->current->node_nb = 0;
+   search->current->total_node_nb = 0;
+   search->current->time = 0.0;
+   search->current->speed = 0.0;
+   search->current->cpu = 0.0;
+}
+
+// search_init_check()
+
+static void search_init_check(search_t * search) {
+
+   sint64 check_inc;
+
+   ASSERT(search!=NULL);
+
+   search->info->check_time = now_real();
+
+   // poll more often when the node budget is small (the threads share it)
+
+   if (search->input->node_is_limited) {
+
+      check_inc = search->input->node_limit / (smp_thread_nb() * 100);
+      if (check_inc < 100) check_inc = 100;
+
+      if (check_inc < search->info->check_inc) {
+         search->info->check_nb = int(check_inc);
+         search->info->check_inc = int(check_inc);
+      }
+
+      search_clip_check(search,0);
+   }
+}
+
+// search_clip_check()
+
+static void search_clip_check(search_t * search, sint64 node_nb) {
+
+   sint64 left;
+
+   ASSERT(search!=NULL);
+   ASSERT(node_nb>=0);
+   ASSERT(search->input->node_is_limited);
+
+   // the next check falls on the node that uses up this thread's share of the budget
+   // (exact with one thread, within a few nodes per thread otherwise)
+
+   left = search->input->node_limit - node_nb;
+   if (left <= 0) return;
+
+   left /= smp_thread_nb();
+   if (left < 1) left = 1;
+
+   if (left < search->info->check_nb) search->info->check_nb = int(left);
 }
 
 // search()
@@ -137,6 +222,7 @@ void search() {
    int move;
    int depth;
 
+   ASSERT(Search->input==SearchInput);
    ASSERT(board_is_ok(SearchInput->board));
 
    // opening book
@@ -149,14 +235,14 @@ void search() {
 
          // play book move
 
-         SearchBest->move = move;
-         SearchBest->value = 1;
-         SearchBest->flags = SearchExact;
-         SearchBest->depth = 1;
-         SearchBest->pv[0] = move;
-         SearchBest->pv[1] = MoveNone;
+         Search->best->move = move;
+         Search->best->value = 1;
+         Search->best->flags = SearchExact;
+         Search->best->depth = 1;
+         Search->best->pv[0] = move;
+         Search->best->pv[1] = MoveNone;
 
-         search_update_best();
+         search_update_best(Search);
 
          return;
       }
@@ -172,31 +258,39 @@ void search() {
       SearchInput->depth_limit = 4; // was 1
    }
 
-   // SearchInfo
+   SearchInput->multipv = option_get_int("MultiPV");
+   if (SearchInput->multipv > LIST_SIZE(SearchInput->list)) SearchInput->multipv = LIST_SIZE(SearchInput->list);
+   if (SearchInput->multipv < 1) SearchInput->multipv = 1;
+   ASSERT(SearchInput->multipv<=MultiPVMax);
 
-   if (setjmp(SearchInfo->buf) != 0) {
-      ASSERT(SearchInfo->can_stop);
-      ASSERT(SearchBest->move!=MoveNone);
-      search_update_current();
-      return;
-   }
+   // info
 
-   // SearchRoot
+   search_init_check(Search);
 
-   list_copy(SearchRoot->list,SearchInput->list);
+   // root
 
-   // SearchCurrent
+   list_copy(Search->root->list,SearchInput->list);
 
-   board_copy(SearchCurrent->board,SearchInput->board);
-   my_timer_reset(SearchCurrent->timer);
-   my_timer_start(SearchCurrent->timer);
+   // current
+
+   board_copy(Search->current->board,SearchInput->board);
+   my_timer_reset(Search->current->timer);
+   my_timer_start(Search->current->timer);
 
    // init
 
    trans_inc_date(Trans);
 
    sort_init();
-   search_full_init(SearchRoot->list,SearchCurrent->board);
+   sort_clear(Search);
+
+   search_full_init(Search,Search->root->list,Search->current->board);
+
+   // helper threads
+
+   list_copy(SearchInput->list,Search->root->list); // share the sorted root list
+
+   search_smp_start();
 
    // iterative deepening
 
@@ -204,86 +298,205 @@ void search() {
 
       if (DispDepthStart) send("info depth %d",depth);
 
-      SearchRoot->bad_1 = false;
-      SearchRoot->change = false;
+      Search->root->bad_1 = false;
+      Search->root->change = false;
 
-      board_copy(SearchCurrent->board,SearchInput->board);
+      board_copy(Search->current->board,SearchInput->board);
 
 #ifdef SHORT_SEARCH_OPTION
       if (UseShortSearch && depth <= ShortSearchDepth)
       {
-         search_full_root(SearchRoot->list,SearchCurrent->board,depth,SearchShort);
+         search_full_root(Search,Search->root->list,Search->current->board,depth,SearchShort);
       }
       else
 #endif
       {
-         search_full_root(SearchRoot->list,SearchCurrent->board,depth,SearchNormal);
+         search_full_root(Search,Search->root->list,Search->current->board,depth,SearchNormal);
       }
 
-      search_update_current();
+      if (Search->info->stopped) break;
+
+      search_update_current(Search);
 
       if (DispDepthEnd) {
-         send("info depth %d seldepth %d time %.0f nodes " S64_FORMAT " nps %.0f",depth,SearchCurrent->max_depth,SearchCurrent->time*1000.0,SearchCurrent->node_nb,SearchCurrent->speed);
+         send("info depth %d seldepth %d time %.0f nodes " S64_FORMAT " nps %.0f",depth,Search->current->max_depth,Search->current->time*1000.0,Search->current->total_node_nb,Search->current->speed);
       }
 
+      if (SearchInput->multipv > 1) search_send_lines();
+
       // update search info
 
-      if (depth >= 1) SearchInfo->can_stop = true;
+      if (depth >= 1) Search->info->can_stop = true;
 
       if (depth == 1
-       && LIST_SIZE(SearchRoot->list) >= 2
-       && LIST_VALUE(SearchRoot->list,0) >= LIST_VALUE(SearchRoot->list,1) + EasyThreshold) {
-         SearchRoot->easy = true;
+       && LIST_SIZE(Search->root->list) >= 2
+       && LIST_VALUE(Search->root->list,0) >= LIST_VALUE(Search->root->list,1) + EasyThreshold) {
+         Search->root->easy = true;
       }
 
       if (UseBad && depth > 1) {
-         SearchRoot->bad_2 = SearchRoot->bad_1;
-         SearchRoot->bad_1 = false;
-         ASSERT(SearchRoot->bad_2==(SearchBest->value<=SearchRoot->last_value-BadThreshold));
+         Search->root->bad_2 = Search->root->bad_1;
+         Search->root->bad_1 = false;
+         ASSERT(Search->root->bad_2==(Search->best->value<=Search->root->last_value-BadThreshold));
       }
 
-      SearchRoot->last_value = SearchBest->value;
+      Search->root->last_value = Search->best->value;
 
       // stop search?
 
       if (SearchInput->depth_is_limited
        && depth >= SearchInput->depth_limit) {
-         SearchRoot->flag = true;
+         Search->root->flag = true;
       }
 
       if (SearchInput->time_is_limited
-       && SearchCurrent->time >= SearchInput->time_limit_1
-       && !SearchRoot->bad_2) {
-         SearchRoot->flag = true;
+       && Search->current->time >= SearchInput->time_limit_1
+       && !Search->root->bad_2) {
+         Search->root->flag = true;
+      }
+
+      if (SearchInput->node_is_limited
+       && Search->current->total_node_nb >= SearchInput->node_limit) {
+         Search->root->flag = true;
       }
 
       if (UseEasy
        && SearchInput->time_is_limited
-       && SearchCurrent->time >= SearchInput->time_limit_1 * EasyRatio
-       && SearchRoot->easy) {
-         ASSERT(!SearchRoot->bad_2);
-         ASSERT(!SearchRoot->change);
-         SearchRoot->flag = true;
+       && Search->current->time >= SearchInput->time_limit_1 * EasyRatio
+       && Search->root->easy) {
+         ASSERT(!Search->root->bad_2);
+         ASSERT(!Search->root->change);
+         Search->root->flag = true;
       }
 
       if (UseEarly
        && SearchInput->time_is_limited
-       && SearchCurrent->time >= SearchInput->time_limit_1 * EarlyRatio
-       && !SearchRoot->bad_2
-       && !SearchRoot->change) {
-         SearchRoot->flag = true;
+       && Search->current->time >= SearchInput->time_limit_1 * EarlyRatio
+       && !Search->root->bad_2
+       && !Search->root->change) {
+         Search->root->flag = true;
       }
 
-      if (SearchInfo->can_stop
-       && (SearchInfo->stop || (SearchRoot->flag && !SearchInput->infinite))) {
+      if (Search->info->can_stop
+       && (Search->info->stop || (Search->root->flag && !SearchInput->infinite))) {
          break;
       }
    }
+
+   search_smp_end();
+
+   ASSERT(!Search->info->stopped||Search->info->can_stop);
+   ASSERT(Search->best->move!=MoveNone);
+
+   search_update_current(Search); // count the nodes the helpers searched until smp_stop()
+}
+
+// search_smp()
+
+void search_smp(int id) {
+
+   search_t * search;
+   int depth;
+
+   ASSERT(id>0&&id<smp_thread_nb());
+
+   // init, the helper has its own context for the duration of the search
+
+   search = (search_t *) my_malloc(sizeof(search_t));
+
+   search->input = SearchInput;
+   search_clear_thread(search);
+   search->info->id = id;
+
+   *search->param = *Search->param; // the options were read by the main thread
+
+   search_init_check(search);
+
+   list_copy(search->root->list,search->input->list);
+
+   board_copy(search->current->board,search->input->board);
+   my_timer_reset(search->current->timer);
+   my_timer_start(search->current->timer);
+
+   sort_clear(search);
+
+   // iterative deepening, odd helpers start one ply deeper to spread the work
+
+   for (depth = 1 + (id & 1); depth < DepthMax; depth++) {
+
+      if (smp_is_stopped()) break;
+
+      board_copy(search->current->board,search->input->board);
+
+      search_full_root(search,search->root->list,search->current->board,depth,SearchNormal);
+
+      if (search->info->stopped) break;
+
+      if (search->input->depth_is_limited
+       && depth >= search->input->depth_limit) {
+         break;
+      }
+   }
+
+   SmpBest[id] = *search->best;
+   SmpNodeNb[id] = search->current->node_nb;
+
+   my_free(search);
+}
+
+// search_smp_start()
+
+static void search_smp_start() {
+
+   int id;
+
+   SmpNodeNb[0] = 0; // published by search_check() for node-limited helpers
+
+   for (id = 1; id < smp_thread_nb(); id++) {
+      SmpBest[id].move = MoveNone;
+      SmpNodeNb[id] = 0;
+   }
+
+   smp_start();
+}
+
+// search_smp_end()
+
+static void search_smp_end() {
+
+   int id;
+   const search_best_t * best;
+   bool found;
+
+   ASSERT(Search->info->id==0);
+
+   smp_stop();
+
+   if (SearchInput->multipv > 1) return; // the lines belong to the main thread
+
+   // pick the deepest (then highest) exact result among all threads
+
+   found = false;
+
+   for (id = 1; id < smp_thread_nb(); id++) {
+
+      best = &SmpBest[id];
+
+      if (best->move != MoveNone
+       && best->flags == SearchExact
+       && (best->depth > Search->best->depth
+        || (best->depth == Search->best->depth && best->value > Search->best->value))) {
+         *Search->best = *best;
+         found = true;
+      }
+   }
+
+   if (found) search_update_best(Search); // the GUI must see the PV of the move we play
 }
 
 // search_update_best()
 
-void search_update_best() {
+void search_update_best(search_t * search) {
 
    int move, value, flags, depth, max_depth;
    const mv_t * pv;
@@ -292,19 +505,19 @@ void search_update_best() {
    int mate;
    char move_string[256], pv_string[512];
 
-   search_update_current();
+   search_update_current(search);
 
-   if (DispBest) {
+   if (DispBest && search->info->id == 0 && search->input->multipv == 1) { // MultiPV lines are sent per iteration
 
-      move = SearchBest->move;
-      value = SearchBest->value;
-      flags = SearchBest->flags;
-      depth = SearchBest->depth;
-      pv = SearchBest->pv;
+      move = search->best->move;
+      value = search->best->value;
+      flags = search->best->flags;
+      depth = search->best->depth;
+      pv = search->best->pv;
 
-      max_depth = SearchCurrent->max_depth;
-      time = SearchCurrent->time;
-      node_nb = SearchCurrent->node_nb;
+      max_depth = search->current->max_depth;
+      time = search->current->time;
+      node_nb = search->current->total_node_nb;
 
       move_to_string(move,move_string,256);
       pv_to_string(pv,pv_string,512);
@@ -341,38 +554,66 @@ void search_update_best() {
 
    // update time-management info
 
-   if (UseBad && SearchBest->depth > 1) {
-      if (SearchBest->value <= SearchRoot->last_value - BadThreshold) {
-         SearchRoot->bad_1 = true;
-         SearchRoot->easy = false;
-         SearchRoot->flag = false;
+   if (UseBad && search->best->depth > 1) {
+      if (search->best->value <= search->root->last_value - BadThreshold) {
+         search->root->bad_1 = true;
+         search->root->easy = false;
+         search->root->flag = false;
+      } else {
+         search->root->bad_1 = false;
+      }
+   }
+}
+
+// search_send_lines()
+
+static void search_send_lines() {
+
+   int i;
+   const search_line_t * line;
+   int mate;
+   char pv_string[512];
+
+   ASSERT(Search->info->id==0);
+   ASSERT(Search->root->line_nb<=SearchInput->multipv);
+
+   for (i = 0; i < Search->root->line_nb; i++) {
+
+      line = &Search->root->line[i];
+
+      pv_to_string(line->pv,pv_string,512);
+
+      mate = value_to_mate(line->value);
+
+      if (mate == 0) {
+         send("info multipv %d depth %d seldepth %d score cp %d time %.0f nodes " S64_FORMAT " pv %s",i+1,Search->root->depth,Search->current->max_depth,line->value,Search->current->time*1000.0,Search->current->total_node_nb,pv_string);
       } else {
-         SearchRoot->bad_1 = false;
+         send("info multipv %d depth %d seldepth %d score mate %d time %.0f nodes " S64_FORMAT " pv %s",i+1,Search->root->depth,Search->current->max_depth,mate,Search->current->time*1000.0,Search->current->total_node_nb,pv_string);
       }
    }
 }
 
 // search_update_root()
 
-void search_update_root() {
+void search_update_root(search_t * search) {
 
    int move, move_pos, move_nb;
    double time;
    sint64 node_nb;
    char move_string[256];
 
-   if (DispRoot) {
+   if (DispRoot && search->info->id == 0) {
 
-      search_update_current();
+      search_update_current(search);
 
-      if (SearchCurrent->time >= 1.0) {
+      if (search->current->time >= 1.0) {
 
-         move = SearchRoot->move;
-         move_pos = SearchRoot->move_pos;
-         move_nb = SearchRoot->move_nb;
+         move = search->root->move;
+         move_pos = search->root->move_pos;
+         move_nb = search->root->move_nb;
 
-         time = SearchCurrent->time;
-         node_nb = SearchCurrent->node_nb;
+         time = search->current->time;
+         node_nb = search->current->total_node_nb;
 
          move_to_string(move,move_string,256);
 
@@ -383,73 +624,144 @@ void search_update_root() {
 
 // search_update_current()
 
-void search_update_current() {
+void search_update_current(search_t * search) {
 
    my_timer_t *timer;
    sint64 node_nb;
    double time, speed, cpu;
+   int id;
+
+   timer = search->current->timer;
 
-   timer = SearchCurrent->timer;
+   node_nb = search->current->node_nb;
+
+   if (search->info->id == 0) { // add the helper threads
+      for (id = 1; id < smp_thread_nb(); id++) node_nb += SmpNodeNb[id];
+   }
 
-   node_nb = SearchCurrent->node_nb;
    time = (UseCpuTime) ? my_timer_elapsed_cpu(timer) : my_timer_elapsed_real(timer);
    speed = (time >= 1.0) ? double(node_nb) / time : 0.0;
    cpu = my_timer_cpu_usage(timer);
 
-   SearchCurrent->time = time;
-   SearchCurrent->speed = speed;
-   SearchCurrent->cpu = cpu;
+   search->current->total_node_nb = node_nb;
+   search->current->time = time;
+   search->current->speed = speed;
+   search->current->cpu = cpu;
 }
 
 // search_check()
 
-void search_check() {
+void search_check(search_t * search) {
+
+   sint64 node_nb;
+   int id;
+
+   if (UseCheckTime && !search->input->node_is_limited) search_adapt_check(search);
+
+   SmpNodeNb[search->info->id] = search->current->node_nb;
 
-   search_send_stat();
+   // helper threads obey the main thread, and the shared node budget
+
+   if (search->info->id != 0) {
+
+      if (smp_is_stopped()) search->info->stopped = true;
+
+      if (search->input->node_is_limited) {
+
+         node_nb = 0;
+         for (id = 0; id < smp_thread_nb(); id++) node_nb += SmpNodeNb[id];
+
+         if (node_nb >= search->input->node_limit) search->info->stopped = true;
+
+         search_clip_check(search,node_nb);
+      }
+
+      return;
+   }
+
+   search_send_stat(search);
 
    if (UseEvent) event();
 
-   if (SearchInput->depth_is_limited
-    && SearchRoot->depth > SearchInput->depth_limit) {
-      SearchRoot->flag = true;
+   if (search->input->depth_is_limited
+    && search->root->depth > search->input->depth_limit) {
+      search->root->flag = true;
    }
 
-   if (SearchInput->time_is_limited
-    && SearchCurrent->time >= SearchInput->time_limit_2) {
-      SearchRoot->flag = true;
+   if (search->input->time_is_limited
+    && search->current->time >= search->input->time_limit_2) {
+      search->root->flag = true;
    }
 
-   if (SearchInput->time_is_limited
-    && SearchCurrent->time >= SearchInput->time_limit_1
-    && !SearchRoot->bad_1
-    && !SearchRoot->bad_2
-    && (!UseExtension || SearchRoot->move_pos == 0)) {
-      SearchRoot->flag = true;
+   if (search->input->node_is_limited
+    && search->current->total_node_nb >= search->input->node_limit) {
+      search->root->flag = true;
+   }
+
+   if (search->input->node_is_limited) search_clip_check(search,search->current->total_node_nb);
+
+   if (search->input->time_is_limited
+    && search->current->time >= search->input->time_limit_1
+    && !search->root->bad_1
+    && !search->root->bad_2
+    && (!UseExtension || search->root->move_pos == 0)) {
+      search->root->flag = true;
    }
 
-   if (SearchInfo->can_stop
-    && (SearchInfo->stop || (SearchRoot->flag && !SearchInput->infinite))) {
-      longjmp(SearchInfo->buf,1);
+   if (search->info->can_stop
+    && (search->info->stop || (search->root->flag && !search->input->infinite))) {
+      search->info->stopped = true;
    }
 }
 
+// search_adapt_check()
+
+static void search_adapt_check(search_t * search) {
+
+   double time, elapsed;
+   int check_inc;
+
+   ASSERT(search!=NULL);
+
+   // scale the node interval so that the next check comes CheckTime seconds later
+
+   time = now_real();
+   elapsed = time - search->info->check_time;
+   search->info->check_time = time;
+
+   check_inc = search->info->check_inc;
+
+   if (elapsed * 2.0 < CheckTime) {
+      check_inc *= 2;
+   } else if (elapsed > CheckTime * 2.0) {
+      check_inc /= 2;
+   } else {
+      check_inc = int(double(check_inc) * CheckTime / elapsed);
+   }
+
+   if (check_inc < CheckIncMin) check_inc = CheckIncMin;
+   if (check_inc > CheckIncMax) check_inc = CheckIncMax;
+
+   search->info->check_inc = check_inc;
+}
+
 // search_send_stat()
 
-static void search_send_stat() {
+static void search_send_stat(search_t * search) {
 
    double time, speed, cpu;
    sint64 node_nb;
 
-   search_update_current();
+   search_update_current(search);
 
-   if (DispStat && SearchCurrent->time >= SearchInfo->last_time + 1.0) { // at least one-second gap
+   if (DispStat && search->current->time >= search->info->last_time + 1.0) { // at least one-second gap
 
-      SearchInfo->last_time = SearchCurrent->time;
+      search->info->last_time = search->current->time;
 
-      time = SearchCurrent->time;
-      speed = SearchCurrent->speed;
-      cpu = SearchCurrent->cpu;
-      node_nb = SearchCurrent->node_nb;
+      time = search->current->time;
+      speed = search->current->speed;
+      cpu = search->current->cpu;
+      node_nb = search->current->total_node_nb;
 
       send("info time %.0f nodes " S64_FORMAT " nps %.0f cpuload %.0f",time*1000.0,node_nb,speed,cpu*1000.0);
 
@@ -6,8 +6,6 @@
 
 // includes
 
-#include <csetjmp>
-
 #include "board.h"
 #include "list.h"
 #include "move.h"
@@ -18,6 +16,8 @@
 const int DepthMax = 96;
 const int HeightMax = 256;
 
+const int MultiPVMax = 64;
+
 const int SearchNormal = 0;
 const int SearchShort  = 1;
 
@@ -26,6 +26,12 @@ const int SearchUpper   = 1;
 const int SearchLower   = 2;
 const int SearchExact   = 3;
 
+const int KillerNb = 2;
+const int HistorySize = 12 * 64;
+
+const int LmrDepthNb = 64;
+const int LmrMoveMax = 64;
+
 // types
 
 struct search_input_t {
@@ -37,17 +43,28 @@ struct search_input_t {
    bool time_is_limited;
    double time_limit_1;
    double time_limit_2;
+   bool node_is_limited;
+   sint64 node_limit; // summed over all threads
+   int multipv;
 };
 
 struct search_info_t {
-   jmp_buf buf;
+   int id;
    bool can_stop;
    bool stop;
+   bool stopped; // unwinding after search_check() aborted the search
    int check_nb;
    int check_inc;
+   double check_time;
    double last_time;
 };
 
+struct search_line_t {
+   int move;
+   int value;
+   mv_t pv[HeightMax];
+};
+
 struct search_root_t {
    list_t list[1];
    int depth;
@@ -60,6 +77,8 @@ struct search_root_t {
    bool change;
    bool easy;
    bool flag;
+   int line_nb;
+   search_line_t line[MultiPVMax]; // best root moves in MultiPV mode
 };
 
 struct search_best_t {
@@ -75,18 +94,50 @@ struct search_current_t {
    my_timer_t timer[1];
    int max_depth;
    sint64 node_nb;
+   sint64 total_node_nb;
    double time;
    double speed;
    double cpu;
 };
 
+struct search_param_t { // from the UCI options, see search_full_init()
+   bool use_null;
+   bool use_null_eval;
+   int null_reduction;
+   bool use_ver;
+   bool use_ver_endgame;
+   int ver_reduction;
+   bool use_lmr;
+   int lmr_base;
+   int lmr_divisor;
+   int history_value;
+   bool use_futility;
+   int futility_margin;
+   bool use_delta;
+   int delta_margin;
+   int check_nb;
+   int check_depth;
+   sint8 lmr_reduction[LmrDepthNb][LmrMoveMax];
+};
+
+struct search_t { // everything one search thread reads and writes
+   search_input_t * input; // may be shared
+   search_info_t info[1];
+   search_root_t root[1];
+   search_best_t best[1];
+   search_current_t current[1];
+   search_param_t param[1];
+   list_t list[HeightMax]; // move lists for sort.cpp, one per height
+   uint16 killer[HeightMax][KillerNb];
+   uint16 history[HistorySize];
+   uint16 hist_hit[HistorySize];
+   uint16 hist_tot[HistorySize];
+};
+
 // variables
 
-extern search_input_t SearchInput[1];
-extern search_info_t SearchInfo[1];
-extern search_best_t SearchBest[1];
-extern search_root_t SearchRoot[1];
-extern search_current_t SearchCurrent[1];
+extern search_input_t SearchInput[1]; // shared by all threads
+extern search_t Search[1]; // the main thread
 
 // functions
 
@@ -95,12 +146,13 @@ extern bool height_is_ok          (int height);
 
 extern void search_clear          ();
 extern void search                ();
+extern void search_smp            (int id);
 
-extern void search_update_best    ();
-extern void search_update_root    ();
-extern void search_update_current ();
+extern void search_update_best    (search_t * search);
+extern void search_update_root    (search_t * search);
+extern void search_update_current (search_t * search);
 
-extern void search_check          ();
+extern void search_check          (search_t * search);
 
 #endif // !defined SEARCH_H
 
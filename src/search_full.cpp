@@ -3,6 +3,8 @@
 
 // includes
 
+#include <cmath>
+
 #include "attack.h"
 #include "board.h"
 #include "colour.h"
@@ -30,6 +32,12 @@
 
 static const bool UseDistancePruning = true;
 
+// aspiration windows at the root
+
+static const bool UseAspiration = true;
+static const int AspirationDepth = 4;
+static const int AspirationWindow = 10;
+
 // transposition table
 
 static const bool UseTrans = true;
@@ -37,16 +45,9 @@ static const int TransDepth = 1;
 
 static const bool UseMateValues = true; // use mate values from shallower searches?
 
-// null move
+// null move, the switches and reductions are in search_param_t
 
-static /* const */ bool UseNull = true;
-static /* const */ bool UseNullEval = true; // true
 static const int NullDepth = 2;
-static /* const */ int NullReduction = 3;
-
-static /* const */ bool UseVer = true;
-static /* const */ bool UseVerEndgame = true; // true
-static /* const */ int VerReduction = 5; // was 3
 
 // move ordering
 
@@ -58,26 +59,10 @@ static const int IIDReduction = 2;
 
 static const bool ExtendSingleReply = true; // true
 
-// history pruning
-
-static /* const */ bool UseHistory = false;
-static const int HistoryDepth = 3;
-static const int HistoryMoveNb = 3;
-static /* const */ int HistoryValue = 9830; // 60%
-static const bool HistoryReSearch = true;
-
-// futility pruning
+// late-move reductions, the table is in search_param_t
 
-static /* const */ bool UseFutility = false; // false
-static /* const */ int FutilityMargin = 100;
-
-// quiescence search
-
-static /* const */ bool UseDelta = false; // false
-static /* const */ int DeltaMargin = 50;
-
-static /* const */ int CheckNb = 1;
-static /* const */ int CheckDepth = 0; // 1 - CheckNb
+static const int LmrDepth = 3;
+static const int LmrMoveNb = 3;
 
 // misc
 
@@ -92,12 +77,13 @@ static const int NodeCut = +1;
 
 // prototypes
 
-static int  full_root            (list_t * list, board_t * board, int alpha, int beta, int depth, int height, int search_type);
+static int  full_root            (search_t * search, list_t * list, board_t * board, int alpha, int beta, int depth, int height, int search_type);
+static void full_root_line       (search_t * search, int move, int value, const mv_t pv[], int multipv);
 
-static int  full_search          (board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type);
-static int  full_no_null         (board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type, int trans_move, int * best_move);
+static int  full_search          (search_t * search, board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type);
+static int  full_no_null         (search_t * search, board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type, int trans_move, int * best_move);
 
-static int  full_quiescence      (board_t * board, int alpha, int beta, int depth, int height, mv_t pv[]);
+static int  full_quiescence      (search_t * search, board_t * board, int alpha, int beta, int depth, int height, mv_t pv[]);
 
 static int  full_new_depth       (int depth, int move, board_t * board, bool single_reply, bool in_pv);
 
@@ -115,75 +101,97 @@ static bool simple_stalemate     (const board_t * board);
 
 // search_full_init()
 
-void search_full_init(list_t * list, board_t * board) {
+void search_full_init(search_t * search, list_t * list, board_t * board) {
 
+   search_param_t * param;
    const char * string;
    int trans_move, trans_min_depth, trans_max_depth, trans_min_value, trans_max_value;
+   int depth, move_nb;
+   double reduction;
 
+   ASSERT(search!=NULL);
    ASSERT(list_is_ok(list));
    ASSERT(board_is_ok(board));
 
+   param = search->param;
+
    // null-move options
 
    string = option_get_string("NullMove Pruning");
 
    if (false) {
    } else if (my_string_equal(string,"Always")) {
-      UseNull = true;
-      UseNullEval = false;
+      param->use_null = true;
+      param->use_null_eval = false;
    } else if (my_string_equal(string,"Fail High")) {
-      UseNull = true;
-      UseNullEval = true;
+      param->use_null = true;
+      param->use_null_eval = true;
    } else if (my_string_equal(string,"Never")) {
-      UseNull = false;
-      UseNullEval = false;
+      param->use_null = false;
+      param->use_null_eval = false;
    } else {
       ASSERT(false);
-      UseNull = true;
-      UseNullEval = true;
+      param->use_null = true;
+      param->use_null_eval = true;
    }
 
-   NullReduction = option_get_int("NullMove Reduction");
+   param->null_reduction = option_get_int("NullMove Reduction");
 
    string = option_get_string("Verification Search");
 
    if (false) {
    } else if (my_string_equal(string,"Always")) {
-      UseVer = true;
-      UseVerEndgame = false;
+      param->use_ver = true;
+      param->use_ver_endgame = false;
    } else if (my_string_equal(string,"Endgame")) {
-      UseVer = true;
-      UseVerEndgame = true;
+      param->use_ver = true;
+      param->use_ver_endgame = true;
    } else if (my_string_equal(string,"Never")) {
-      UseVer = false;
-      UseVerEndgame = false;
+      param->use_ver = false;
+      param->use_ver_endgame = false;
    } else {
       ASSERT(false);
-      UseVer = true;
-      UseVerEndgame = true;
+      param->use_ver = true;
+      param->use_ver_endgame = true;
    }
 
-   VerReduction = option_get_int("Verification Reduction");
+   param->ver_reduction = option_get_int("Verification Reduction");
+
+   // late-move-reduction options
+
+   param->use_lmr = option_get_bool("Late Move Reductions");
+   param->lmr_base = option_get_int("LMR Base");
+   param->lmr_divisor = option_get_int("LMR Divisor");
+   param->history_value = (option_get_int("History Threshold") * 16384 + 50) / 100;
 
-   // history-pruning options
+   ASSERT(param->lmr_divisor>0);
 
-   UseHistory = option_get_bool("History Pruning");
-   HistoryValue = (option_get_int("History Threshold") * 16384 + 50) / 100;
+   // reduction = base + log(depth) * log(move number) / divisor, rounded down
+
+   for (depth = 0; depth < LmrDepthNb; depth++) {
+      for (move_nb = 0; move_nb < LmrMoveMax; move_nb++) {
+         reduction = 0.0;
+         if (depth > 0 && move_nb > 0) {
+            reduction = double(param->lmr_base) / 100.0 + log(double(depth)) * log(double(move_nb)) * 100.0 / double(param->lmr_divisor);
+         }
+         param->lmr_reduction[depth][move_nb] = int(reduction);
+      }
+   }
 
    // futility-pruning options
 
-   UseFutility = option_get_bool("Futility Pruning");
-   FutilityMargin = option_get_int("Futility Margin");
+   param->use_futility = option_get_bool("Futility Pruning");
+   param->futility_margin = option_get_int("Futility Margin");
 
    // delta-pruning options
 
-   UseDelta = option_get_bool("Delta Pruning");
-   DeltaMargin = option_get_int("Delta Margin");
+   param->use_delta = option_get_bool("Delta Pruning");
+   param->delta_margin = option_get_int("Delta Margin");
 
    // quiescence-search options
 
-   CheckNb = option_get_int("Quiescence Check Plies");
-   CheckDepth = 1 - CheckNb;
+   param->check_nb = option_get_int("Quiescence Check Plies");
+   param->check_depth = 1 - param->check_nb;
 
    // standard sort
 
@@ -195,29 +203,78 @@ void search_full_init(list_t * list, board_t * board) {
    trans_move = MoveNone;
    if (UseTrans) trans_retrieve(Trans,board->key,&trans_move,&trans_min_depth,&trans_max_depth,&trans_min_value,&trans_max_value);
 
-   note_moves(list,board,0,trans_move);
+   note_moves(search,list,board,0,trans_move);
    list_sort(list);
 }
 
 // search_full_root()
 
-int search_full_root(list_t * list, board_t * board, int depth, int search_type) {
-
+int search_full_root(search_t * search, list_t * list, board_t * board, int depth, int search_type) {
 
+   int alpha, beta, delta;
    int value;
 
+   ASSERT(search!=NULL);
    ASSERT(list_is_ok(list));
    ASSERT(board_is_ok(board));
    ASSERT(depth_is_ok(depth));
    ASSERT(search_type==SearchNormal||search_type==SearchShort);
 
-   ASSERT(list==SearchRoot->list);
+   ASSERT(list==search->root->list);
    ASSERT(!LIST_IS_EMPTY(list));
-   ASSERT(board==SearchCurrent->board);
+   ASSERT(board==search->current->board);
    ASSERT(board_is_legal(board));
    ASSERT(depth>=1);
 
-   value = full_root(list,board,-ValueInf,+ValueInf,depth,0,search_type);
+   // aspiration window around the previous iteration's score, MultiPV needs the full window
+
+   alpha = -ValueInf;
+   beta = +ValueInf;
+   delta = AspirationWindow;
+
+   if (UseAspiration
+    && search_type == SearchNormal
+    && search->input->multipv == 1
+    && depth >= AspirationDepth
+    && search->best->depth == depth - 1
+    && search->best->flags == SearchExact
+    && !value_is_mate(search->best->value)) {
+
+      alpha = search->best->value - delta;
+      beta = search->best->value + delta;
+   }
+
+   while (true) {
+
+      value = full_root(search,list,board,alpha,beta,depth,0,search_type);
+
+      if (search->info->stopped) return ValueDraw; // the caller keeps the last complete result
+
+      if (value <= alpha && alpha > -ValueInf) {
+
+         // fail low, the score dropped: do not let time management stop now
+
+         search->root->bad_1 = true;
+         search->root->easy = false;
+         search->root->flag = false;
+
+         alpha = value - delta;
+         if (alpha < -ValueInf) alpha = -ValueInf;
+
+      } else if (value >= beta && beta < +ValueInf) {
+
+         // fail high
+
+         beta = value + delta;
+         if (beta > +ValueInf) beta = +ValueInf;
+
+      } else {
+
+         break;
+      }
+
+      delta *= 2;
+   }
 
    ASSERT(value_is_ok(value));
    ASSERT(LIST_VALUE(list,0)==value);
@@ -227,15 +284,17 @@ int search_full_root(list_t * list, board_t * board, int depth, int search_type)
 
 // full_root()
 
-static int full_root(list_t * list, board_t * board, int alpha, int beta, int depth, int height, int search_type) {
+static int full_root(search_t * search, list_t * list, board_t * board, int alpha, int beta, int depth, int height, int search_type) {
 
    int old_alpha;
    int value, best_value;
    int i, move;
    int new_depth;
+   int multipv;
    undo_t undo[1];
    mv_t new_pv[HeightMax];
 
+   ASSERT(search!=NULL);
    ASSERT(list_is_ok(list));
    ASSERT(board_is_ok(board));
    ASSERT(range_is_ok(alpha,beta));
@@ -243,54 +302,63 @@ static int full_root(list_t * list, board_t * board, int alpha, int beta, int de
    ASSERT(height_is_ok(height));
    ASSERT(search_type==SearchNormal||search_type==SearchShort);
 
-   ASSERT(list==SearchRoot->list);
+   ASSERT(list==search->root->list);
    ASSERT(!LIST_IS_EMPTY(list));
-   ASSERT(board==SearchCurrent->board);
+   ASSERT(board==search->current->board);
    ASSERT(board_is_legal(board));
    ASSERT(depth>=1);
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   search->current->node_nb++;
+   search->info->check_nb--;
 
    for (i = 0; i < LIST_SIZE(list); i++) list->value[i] = ValueNone;
 
    old_alpha = alpha;
    best_value = ValueNone;
 
+   // MultiPV: alpha is the value of the worst line once there are enough lines
+
+   multipv = (search_type == SearchNormal) ? search->input->multipv : 1;
+   search->root->line_nb = 0;
+
    // move loop
 
    for (i = 0; i < LIST_SIZE(list); i++) {
 
       move = LIST_MOVE(list,i);
 
-      SearchRoot->depth = depth;
-      SearchRoot->move = move;
-      SearchRoot->move_pos = i;
-      SearchRoot->move_nb = LIST_SIZE(list);
+      search->root->depth = depth;
+      search->root->move = move;
+      search->root->move_pos = i;
+      search->root->move_nb = LIST_SIZE(list);
 
-      search_update_root();
+      search_update_root(search);
 
       new_depth = full_new_depth(depth,move,board,board_is_check(board)&&LIST_SIZE(list)==1,true);
 
       move_do(board,move,undo);
 
       if (search_type == SearchShort || best_value == ValueNone) { // first move
-         value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
+         value = -full_search(search,board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
+      } else if (multipv > 1 && search->root->line_nb < multipv) { // first MultiPV moves
+         value = -full_search(search,board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
       } else { // other moves
-         value = -full_search(board,-alpha-1,-alpha,new_depth,height+1,new_pv,NodeCut);
+         value = -full_search(search,board,-alpha-1,-alpha,new_depth,height+1,new_pv,NodeCut);
          if (value > alpha) { // && value < beta
-            SearchRoot->change = true;
-            SearchRoot->easy = false;
-            SearchRoot->flag = false;
-            search_update_root();
-            value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
+            search->root->change = true;
+            search->root->easy = false;
+            search->root->flag = false;
+            search_update_root(search);
+            value = -full_search(search,board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
          }
       }
 
       move_undo(board,move,undo);
 
+      if (search->info->stopped) return ValueDraw;
+
       if (value <= alpha) { // upper bound
          list->value[i] = old_alpha;
       } else if (value >= beta) { // lower bound
@@ -301,47 +369,99 @@ static int full_root(list_t * list, board_t * board, int alpha, int beta, int de
 
       if (value > best_value && (best_value == ValueNone || value > alpha)) {
 
-         SearchBest->move = move;
-         SearchBest->value = value;
+         search->best->move = move;
+         search->best->value = value;
          if (value <= alpha) { // upper bound
-            SearchBest->flags = SearchUpper;
+            search->best->flags = SearchUpper;
          } else if (value >= beta) { // lower bound
-            SearchBest->flags = SearchLower;
+            search->best->flags = SearchLower;
          } else { // alpha < value < beta => exact value
-            SearchBest->flags = SearchExact;
+            search->best->flags = SearchExact;
          }
-         SearchBest->depth = depth;
-         pv_cat(SearchBest->pv,new_pv,move);
+         search->best->depth = depth;
+         pv_cat(search->best->pv,new_pv,move);
 
-         search_update_best();
+         if (value > alpha) search_update_best(search); // a fail low is sent once the bound is known
+      }
+
+      if (multipv > 1 && value > alpha && value < beta) {
+         full_root_line(search,move,value,new_pv,multipv);
       }
 
       if (value > best_value) {
          best_value = value;
          if (value > alpha) {
-            if (search_type == SearchNormal) alpha = value;
+            if (search_type == SearchNormal && multipv == 1) alpha = value;
             if (value >= beta) break;
          }
       }
+
+      if (multipv > 1 && search->root->line_nb == multipv) {
+         alpha = search->root->line[multipv-1].value;
+         if (alpha < old_alpha) alpha = old_alpha;
+      }
    }
 
    ASSERT(value_is_ok(best_value));
 
+   // fail low: the first move is kept, bounded by the best score of all moves
+
+   if (best_value <= old_alpha) {
+      ASSERT(search->best->flags==SearchUpper);
+      search->best->value = best_value;
+      search_update_best(search);
+   }
+
    list_sort(list);
 
-   ASSERT(SearchBest->move==LIST_MOVE(list,0));
-   ASSERT(SearchBest->value==best_value);
+   ASSERT(search->best->move==LIST_MOVE(list,0));
+   ASSERT(search->best->value==best_value);
 
    if (UseTrans && best_value > old_alpha && best_value < beta) {
-      pv_fill(SearchBest->pv,board);
+      pv_fill(search->best->pv,board);
    }
 
    return best_value;
 }
 
+// full_root_line()
+
+static void full_root_line(search_t * search, int move, int value, const mv_t pv[], int multipv) {
+
+   int line_nb;
+   int pos, i;
+   search_line_t * line;
+
+   ASSERT(search!=NULL);
+   ASSERT(move_is_ok(move));
+   ASSERT(value_is_ok(value));
+   ASSERT(pv!=NULL);
+   ASSERT(multipv>1&&multipv<=MultiPVMax);
+
+   line = search->root->line;
+   line_nb = search->root->line_nb;
+
+   // insert sort (stable), the worst line drops out when the table is full
+
+   for (pos = line_nb; pos > 0 && value > line[pos-1].value; pos--)
+      ;
+
+   ASSERT(pos<multipv);
+
+   if (line_nb < multipv) line_nb++;
+
+   for (i = line_nb-1; i > pos; i--) line[i] = line[i-1];
+
+   line[pos].move = move;
+   line[pos].value = value;
+   pv_cat(line[pos].pv,pv,move);
+
+   search->root->line_nb = line_nb;
+}
+
 // full_search()
 
-static int full_search(board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type) {
+static int full_search(search_t * search, board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type) {
 
    bool in_check;
    bool single_reply;
@@ -354,13 +474,14 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
    int played_nb;
    int i;
    int opt_value;
-   bool reduced;
+   int reduction;
    attack_t attack[1];
    sort_t sort[1];
    undo_t undo[1];
    mv_t new_pv[HeightMax];
    mv_t played[256];
 
+   ASSERT(search!=NULL);
    ASSERT(board!=NULL);
    ASSERT(range_is_ok(alpha,beta));
    ASSERT(depth_is_ok(depth));
@@ -372,19 +493,22 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 
    // horizon?
 
-   if (depth <= 0) return full_quiescence(board,alpha,beta,0,height,pv);
+   if (depth <= 0) return full_quiescence(search,board,alpha,beta,0,height,pv);
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   if (search->info->stopped) return ValueDraw; // unwinding, the value is ignored
+
+   search->current->node_nb++;
+   search->info->check_nb--;
    PV_CLEAR(pv);
 
-   if (height > SearchCurrent->max_depth) SearchCurrent->max_depth = height;
+   if (height > search->current->max_depth) search->current->max_depth = height;
 
-   if (SearchInfo->check_nb <= 0) {
-      SearchInfo->check_nb += SearchInfo->check_inc;
-      search_check();
+   if (search->info->check_nb <= 0) {
+      search->info->check_nb += search->info->check_inc;
+      search_check(search);
+      if (search->info->stopped) return ValueDraw;
    }
 
    // draw?
@@ -473,31 +597,34 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 
    // null-move pruning
 
-   if (UseNull && depth >= NullDepth && node_type != NodePV) {
+   if (search->param->use_null && depth >= NullDepth && node_type != NodePV) {
 
       if (!in_check
        && !value_is_mate(beta)
        && do_null(board)
-       && (!UseNullEval || depth <= NullReduction+1 || eval(board) >= beta)) {
+       && (!search->param->use_null_eval || depth <= search->param->null_reduction+1 || eval(board) >= beta)) {
 
          // null-move search
 
-         new_depth = depth - NullReduction - 1;
+         new_depth = depth - search->param->null_reduction - 1;
 
          move_do_null(board,undo);
-         value = -full_search(board,-beta,-beta+1,new_depth,height+1,new_pv,NODE_OPP(node_type));
+         value = -full_search(search,board,-beta,-beta+1,new_depth,height+1,new_pv,NODE_OPP(node_type));
          move_undo_null(board,undo);
 
+         if (search->info->stopped) return ValueDraw;
+
          // verification search
 
-         if (UseVer && depth > VerReduction) {
+         if (search->param->use_ver && depth > search->param->ver_reduction) {
 
-            if (value >= beta && (!UseVerEndgame || do_ver(board))) {
+            if (value >= beta && (!search->param->use_ver_endgame || do_ver(board))) {
 
-               new_depth = depth - VerReduction;
+               new_depth = depth - search->param->ver_reduction;
                ASSERT(new_depth>0);
 
-               value = full_no_null(board,alpha,beta,new_depth,height,new_pv,NodeCut,trans_move,&move);
+               value = full_no_null(search,board,alpha,beta,new_depth,height,new_pv,NodeCut,trans_move,&move);
+               if (search->info->stopped) return ValueDraw;
 
                if (value >= beta) {
                   ASSERT(move==new_pv[0]);
@@ -533,15 +660,16 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
       new_depth = depth - IIDReduction;
       ASSERT(new_depth>0);
 
-      value = full_search(board,alpha,beta,new_depth,height,new_pv,node_type);
-      if (value <= alpha) value = full_search(board,-ValueInf,beta,new_depth,height,new_pv,node_type);
+      value = full_search(search,board,alpha,beta,new_depth,height,new_pv,node_type);
+      if (value <= alpha) value = full_search(search,board,-ValueInf,beta,new_depth,height,new_pv,node_type);
+      if (search->info->stopped) return ValueDraw;
 
       trans_move = new_pv[0];
    }
 
    // move generation
 
-   sort_init(sort,board,attack,depth,height,trans_move);
+   sort_init(sort,search,board,attack,depth,height,trans_move);
 
    single_reply = false;
    if (in_check && LIST_SIZE(sort->list) == 1) single_reply = true; // HACK
@@ -556,30 +684,33 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 
       new_depth = full_new_depth(depth,move,board,single_reply,node_type==NodePV);
 
-      // history pruning
-
-      reduced = false;
-
-      if (UseHistory && depth >= HistoryDepth && node_type != NodePV) {
-         if (!in_check && played_nb >= HistoryMoveNb && new_depth < depth) {
-            ASSERT(best_value!=ValueNone);
-            ASSERT(played_nb>0);
-            ASSERT(sort->pos>0&&move==LIST_MOVE(sort->list,sort->pos-1));
-            value = sort->value; // history score
-            if (value < HistoryValue) {
-               ASSERT(value>=0&&value<16384);
-               ASSERT(move!=trans_move);
-               ASSERT(!move_is_tactical(move,board));
-               ASSERT(!move_is_check(move,board));
-               new_depth--;
-               reduced = true;
-            }
+      // late-move reductions
+
+      reduction = 0;
+
+      if (search->param->use_lmr && depth >= LmrDepth && !in_check && played_nb >= LmrMoveNb && new_depth < depth) {
+
+         ASSERT(best_value!=ValueNone);
+         ASSERT(sort->pos>0&&move==LIST_MOVE(sort->list,sort->pos-1));
+
+         if (move != trans_move && !move_is_tactical(move,board)) {
+
+            ASSERT(!move_is_check(move,board));
+
+            reduction = search->param->lmr_reduction[(depth<LmrDepthNb)?depth:LmrDepthNb-1][(played_nb<LmrMoveMax)?played_nb:LmrMoveMax-1];
+
+            if (node_type == NodePV) reduction--;
+            if (move == sort->killer_1 || move == sort->killer_2) reduction--;
+            if (sort->value < 16384 && sort->value >= search->param->history_value) reduction--; // quiet move with a good history
+
+            if (reduction > new_depth - 1) reduction = new_depth - 1;
+            if (reduction < 0) reduction = 0;
          }
       }
 
       // futility pruning
 
-      if (UseFutility && depth == 1 && node_type != NodePV) {
+      if (search->param->use_futility && depth == 1 && node_type != NodePV) {
 
          if (!in_check && new_depth == 0 && !move_is_tactical(move,board) && !move_is_dangerous(move,board)) {
 
@@ -588,7 +719,7 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
             // optimistic evaluation
 
             if (opt_value == +ValueInf) {
-               opt_value = eval(board) + FutilityMargin;
+               opt_value = eval(board) + search->param->futility_margin;
                ASSERT(opt_value<+ValueInf);
             }
 
@@ -612,29 +743,25 @@ static int full_search(board_t * board, int alpha, int beta, int depth, int heig
 
       move_do(board,move,undo);
 
-      if (node_type != NodePV || best_value == ValueNone) { // first move
-         value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
-      } else { // other moves
-         value = -full_search(board,-alpha-1,-alpha,new_depth,height+1,new_pv,NodeCut);
-         if (value > alpha) { // && value < beta
-            value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
-         }
+      if (reduction > 0) { // reduced null-window search first
+         value = -full_search(search,board,-alpha-1,-alpha,new_depth-reduction,height+1,new_pv,(node_type==NodePV)?NodeCut:NODE_OPP(node_type));
       }
 
-      // history-pruning re-search
-
-      if (HistoryReSearch && reduced && value >= beta) {
-
-         ASSERT(node_type!=NodePV);
-
-         new_depth++;
-         ASSERT(new_depth==depth-1);
-
-         value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
+      if (reduction == 0 || value > alpha) { // full-depth (re-)search
+         if (node_type != NodePV || best_value == ValueNone) { // first move
+            value = -full_search(search,board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
+         } else { // other moves
+            value = -full_search(search,board,-alpha-1,-alpha,new_depth,height+1,new_pv,NodeCut);
+            if (value > alpha) { // && value < beta
+               value = -full_search(search,board,-beta,-alpha,new_depth,height+1,new_pv,NodePV);
+            }
+         }
       }
 
       move_undo(board,move,undo);
 
+      if (search->info->stopped) return ValueDraw;
+
       played[played_nb++] = move;
 
       if (value > best_value) {
@@ -670,7 +797,7 @@ cut:
 
    if (best_move != MoveNone) {
 
-      good_move(best_move,board,depth,height);
+      good_move(search,best_move,board,depth,height);
 
       if (best_value >= beta && !move_is_tactical(best_move,board)) {
 
@@ -679,10 +806,10 @@ cut:
          for (i = 0; i < played_nb-1; i++) {
             move = played[i];
             ASSERT(move!=best_move);
-            history_bad(move,board);
+            history_bad(search,move,board);
          }
 
-         history_good(best_move,board);
+         history_good(search,best_move,board);
       }
    }
 
@@ -703,7 +830,7 @@ cut:
 
 // full_no_null()
 
-static int full_no_null(board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type, int trans_move, int * best_move) {
+static int full_no_null(search_t * search, board_t * board, int alpha, int beta, int depth, int height, mv_t pv[], int node_type, int trans_move, int * best_move) {
 
    int value, best_value;
    int move;
@@ -713,6 +840,7 @@ static int full_no_null(board_t * board, int alpha, int beta, int depth, int hei
    undo_t undo[1];
    mv_t new_pv[HeightMax];
 
+   ASSERT(search!=NULL);
    ASSERT(board!=NULL);
    ASSERT(range_is_ok(alpha,beta));
    ASSERT(depth_is_ok(depth));
@@ -728,35 +856,41 @@ static int full_no_null(board_t * board, int alpha, int beta, int depth, int hei
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   *best_move = MoveNone;
+
+   if (search->info->stopped) return ValueDraw; // unwinding, the value is ignored
+
+   search->current->node_nb++;
+   search->info->check_nb--;
    PV_CLEAR(pv);
 
-   if (height > SearchCurrent->max_depth) SearchCurrent->max_depth = height;
+   if (height > search->current->max_depth) search->current->max_depth = height;
 
-   if (SearchInfo->check_nb <= 0) {
-      SearchInfo->check_nb += SearchInfo->check_inc;
-      search_check();
+   if (search->info->check_nb <= 0) {
+      search->info->check_nb += search->info->check_inc;
+      search_check(search);
+      if (search->info->stopped) return ValueDraw;
    }
 
    attack_set(attack,board);
    ASSERT(!ATTACK_IN_CHECK(attack));
 
-   *best_move = MoveNone;
    best_value = ValueNone;
 
    // move loop
 
-   sort_init(sort,board,attack,depth,height,trans_move);
+   sort_init(sort,search,board,attack,depth,height,trans_move);
 
    while ((move=sort_next(sort)) != MoveNone) {
 
       new_depth = full_new_depth(depth,move,board,false,false);
 
       move_do(board,move,undo);
-      value = -full_search(board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
+      value = -full_search(search,board,-beta,-alpha,new_depth,height+1,new_pv,NODE_OPP(node_type));
       move_undo(board,move,undo);
 
+      if (search->info->stopped) return ValueDraw;
+
       if (value > best_value) {
          best_value = value;
          pv_cat(pv,new_pv,move);
@@ -784,7 +918,7 @@ cut:
 
 // full_quiescence()
 
-static int full_quiescence(board_t * board, int alpha, int beta, int depth, int height, mv_t pv[]) {
+static int full_quiescence(search_t * search, board_t * board, int alpha, int beta, int depth, int height, mv_t pv[]) {
 
    bool in_check;
    int old_alpha;
@@ -797,6 +931,7 @@ static int full_quiescence(board_t * board, int alpha, int beta, int depth, int
    undo_t undo[1];
    mv_t new_pv[HeightMax];
 
+   ASSERT(search!=NULL);
    ASSERT(board!=NULL);
    ASSERT(range_is_ok(alpha,beta));
    ASSERT(depth_is_ok(depth));
@@ -808,15 +943,18 @@ static int full_quiescence(board_t * board, int alpha, int beta, int depth, int
 
    // init
 
-   SearchCurrent->node_nb++;
-   SearchInfo->check_nb--;
+   if (search->info->stopped) return ValueDraw; // unwinding, the value is ignored
+
+   search->current->node_nb++;
+   search->info->check_nb--;
    PV_CLEAR(pv);
 
-   if (height > SearchCurrent->max_depth) SearchCurrent->max_depth = height;
+   if (height > search->current->max_depth) search->current->max_depth = height;
 
-   if (SearchInfo->check_nb <= 0) {
-      SearchInfo->check_nb += SearchInfo->check_inc;
-      search_check();
+   if (search->info->check_nb <= 0) {
+      search->info->check_nb += search->info->check_inc;
+      search_check(search);
+      if (search->info->stopped) return ValueDraw;
    }
 
    // draw?
@@ -867,7 +1005,7 @@ static int full_quiescence(board_t * board, int alpha, int beta, int depth, int
    best_value = ValueNone;
    best_move = MoveNone;
 
-   /* if (UseDelta) */ opt_value = +ValueInf;
+   /* if (search->param->use_delta) */ opt_value = +ValueInf;
 
    if (!in_check) {
 
@@ -886,21 +1024,21 @@ static int full_quiescence(board_t * board, int alpha, int beta, int depth, int
          if (value >= beta) goto cut;
       }
 
-      if (UseDelta) {
-         opt_value = value + DeltaMargin;
+      if (search->param->use_delta) {
+         opt_value = value + search->param->delta_margin;
          ASSERT(opt_value<+ValueInf);
       }
    }
 
    // move loop
 
-   sort_init_qs(sort,board,attack,depth>=CheckDepth);
+   sort_init_qs(sort,search,board,attack,height,depth>=search->param->check_depth);
 
    while ((move=sort_next_qs(sort)) != MoveNone) {
 
       // delta pruning
 
-      if (UseDelta && beta == old_alpha+1) {
+      if (search->param->use_delta && beta == old_alpha+1) {
 
          if (!in_check && !move_is_check(move,board) && !capture_is_dangerous(move,board)) {
 
@@ -936,9 +1074,11 @@ static int full_quiescence(board_t * board, int alpha, int beta, int depth, int
       }
 
       move_do(board,move,undo);
-      value = -full_quiescence(board,-beta,-alpha,depth-1,height+1,new_pv);
+      value = -full_quiescence(search,board,-beta,-alpha,depth-1,height+1,new_pv);
       move_undo(board,move,undo);
 
+      if (search->info->stopped) return ValueDraw;
+
       if (value > best_value) {
          best_value = value;
          pv_cat(pv,new_pv,move);
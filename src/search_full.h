@@ -7,12 +7,14 @@
 // includes
 
 #include "board.h"
+#include "list.h"
+#include "search.h"
 #include "util.h"
 
 // functions
 
-extern void search_full_init (list_t * list, board_t * board);
-extern int  search_full_root (list_t * list, board_t * board, int depth, int search_type);
+extern void search_full_init (search_t * search, list_t * list, board_t * board);
+extern int  search_full_root (search_t * search, list_t * list, board_t * board, int depth, int search_type);
 
 #endif // !defined SEARCH_FULL_H
 
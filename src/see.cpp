@@ -252,6 +252,9 @@ static void alist_build(alist_t * alist, const board_t * board, int to, int colo
    int inc;
    int sq;
    int pawn;
+#ifdef USE_ATTACK_MAP
+   bitboard_t to_bb;
+#endif
 
    ASSERT(alist!=NULL);
    ASSERT(board!=NULL);
@@ -260,6 +263,18 @@ static void alist_build(alist_t * alist, const board_t * board, int to, int colo
 
    // piece attacks
 
+#ifdef USE_ATTACK_MAP
+
+   if (board->attack_nb[colour][SQUARE_TO_64(to)] == 0) return; // no attacker, pawns included
+
+   to_bb = BB_SQUARE(SQUARE_TO_64(to));
+
+   for (ptr = &board->piece[colour][0]; (from=*ptr) != SquareNone; ptr++) {
+      if ((board->attack_bb[SQUARE_TO_64(from)] & to_bb) != 0) alist_add(alist,from,board);
+   }
+
+#else
+
    for (ptr = &board->piece[colour][0]; (from=*ptr) != SquareNone; ptr++) {
 
       piece = board->square[from];
@@ -281,6 +296,8 @@ static void alist_build(alist_t * alist, const board_t * board, int to, int colo
       }
    }
 
+#endif
+
    // pawn attacks
 
    inc = PAWN_MOVE_INC(colour);
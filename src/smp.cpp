@@ -0,0 +1,192 @@
+
+// smp.cpp
+
+// includes
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "eval.h"
+#include "option.h"
+#include "pawn.h"
+#include "search.h"
+#include "smp.h"
+#include "util.h"
+
+// types
+
+struct smp_t {
+   std::thread * thread[ThreadMax];
+   int thread_nb;
+   std::mutex mutex;
+   std::condition_variable cond;
+   int search_nb;
+   int running;
+   bool quit;
+};
+
+// variables
+
+static smp_t Smp[1];
+
+static std::atomic<bool> Stop;
+
+// prototypes
+
+static void smp_loop (int id, int search_nb);
+
+// functions
+
+// smp_init()
+
+void smp_init() {
+
+   int id;
+
+   for (id = 0; id < ThreadMax; id++) Smp->thread[id] = NULL;
+
+   Smp->thread_nb = 1; // the main thread
+   Smp->search_nb = 0;
+   Smp->running = 0;
+   Smp->quit = false;
+
+   Stop = false;
+}
+
+// smp_alloc()
+
+void smp_alloc() {
+
+   int thread_nb;
+   int id;
+
+   ASSERT(Smp->thread_nb==1);
+
+   thread_nb = option_get_int("Threads");
+   if (thread_nb < 1) thread_nb = 1;
+   if (thread_nb > ThreadMax) thread_nb = ThreadMax;
+
+   Smp->thread_nb = thread_nb;
+   Smp->quit = false;
+
+   // helper threads (the main thread has id 0)
+
+   for (id = 1; id < thread_nb; id++) {
+      Smp->thread[id] = new std::thread(smp_loop,id,Smp->search_nb);
+   }
+}
+
+// smp_free()
+
+void smp_free() {
+
+   int id;
+
+   // abort a search in progress ("quit" or EOF while searching)
+
+   smp_stop();
+
+   // wake up the helpers and wait for them to exit
+
+   {
+      std::lock_guard<std::mutex> lock(Smp->mutex);
+      Smp->quit = true;
+   }
+
+   Smp->cond.notify_all();
+
+   for (id = 1; id < Smp->thread_nb; id++) {
+
+      ASSERT(Smp->thread[id]!=NULL);
+
+      Smp->thread[id]->join();
+      delete Smp->thread[id];
+      Smp->thread[id] = NULL;
+   }
+
+   Smp->thread_nb = 1;
+}
+
+// smp_thread_nb()
+
+int smp_thread_nb() {
+
+   return Smp->thread_nb;
+}
+
+// smp_start()
+
+void smp_start() {
+
+   Stop = false;
+
+   {
+      std::lock_guard<std::mutex> lock(Smp->mutex);
+      Smp->running = Smp->thread_nb - 1;
+      Smp->search_nb++;
+   }
+
+   Smp->cond.notify_all();
+}
+
+// smp_stop()
+
+void smp_stop() {
+
+   std::unique_lock<std::mutex> lock(Smp->mutex);
+
+   Stop = true;
+
+   while (Smp->running != 0) Smp->cond.wait(lock);
+}
+
+// smp_is_stopped()
+
+bool smp_is_stopped() {
+
+   return Stop.load(std::memory_order_relaxed);
+}
+
+// smp_loop()
+
+static void smp_loop(int id, int search_nb) {
+
+   ASSERT(id>0&&id<ThreadMax);
+
+   // per-thread evaluation caches
+
+   pawn_alloc();
+   eval_alloc();
+
+   // wait for searches until told to quit
+
+   while (true) {
+
+      {
+         std::unique_lock<std::mutex> lock(Smp->mutex);
+
+         while (!Smp->quit && Smp->search_nb == search_nb) Smp->cond.wait(lock);
+
+         if (Smp->quit) break;
+         search_nb = Smp->search_nb;
+      }
+
+      search_smp(id);
+
+      {
+         std::lock_guard<std::mutex> lock(Smp->mutex);
+         ASSERT(Smp->running>0);
+         Smp->running--;
+      }
+
+      Smp->cond.notify_all();
+   }
+
+   pawn_free();
+   eval_free();
+}
+
+// end of smp.cpp
+
@@ -0,0 +1,32 @@
+
+// smp.h
+
+#ifndef SMP_H
+#define SMP_H
+
+// includes
+
+#include "util.h"
+
+// constants
+
+const int ThreadMax = 128;
+
+// functions
+
+extern void smp_init       ();
+
+extern void smp_alloc      ();
+extern void smp_free       ();
+
+extern int  smp_thread_nb  ();
+
+extern void smp_start      ();
+extern void smp_stop       ();
+
+extern bool smp_is_stopped ();
+
+#endif // !defined SMP_H
+
+// end of smp.h
+
@@ -21,9 +21,9 @@
 
 // constants
 
-static const int KillerNb = 2;
+static const bool UseSelection = true; // pick the first moves lazily, sort the rest
+static const int SelectNb = 2;
 
-static const int HistorySize = 12 * 64;
 static const int HistoryMax = 16384;
 
 static const int TransScore   = +32766;
@@ -78,25 +78,19 @@ static int PosCaptureQS;
 
 static int Code[CODE_SIZE];
 
-static uint16 Killer[HeightMax][KillerNb];
-
-static uint16 History[HistorySize];
-static uint16 HistHit[HistorySize];
-static uint16 HistTot[HistorySize];
-
 // prototypes
 
 static void note_captures     (list_t * list, const board_t * board);
-static void note_quiet_moves  (list_t * list, const board_t * board);
+static void note_quiet_moves  (const search_t * search, list_t * list, const board_t * board);
 static void note_moves_simple (list_t * list, const board_t * board);
 static void note_mvv_lva      (list_t * list, const board_t * board);
 
-static int  move_value        (int move, const board_t * board, int height, int trans_killer);
+static int  move_value        (const search_t * search, int move, const board_t * board, int height, int trans_killer);
 static int  capture_value     (int move, const board_t * board);
-static int  quiet_move_value  (int move, const board_t * board);
+static int  quiet_move_value  (const search_t * search, int move, const board_t * board);
 static int  move_value_simple (int move, const board_t * board);
 
-static int  history_prob      (int move, const board_t * board);
+static int  history_prob      (const search_t * search, int move, const board_t * board);
 
 static bool capture_is_good   (int move, const board_t * board);
 
@@ -110,24 +104,8 @@ static int  history_index     (int move, const board_t * board);
 
 void sort_init() {
 
-   int i, height;
    int pos;
 
-   // killer
-
-   for (height = 0; height < HeightMax; height++) {
-      for (i = 0; i < KillerNb; i++) Killer[height][i] = MoveNone;
-   }
-
-   // history
-
-   for (i = 0; i < HistorySize; i++) History[i] = 0;
-
-   for (i = 0; i < HistorySize; i++) {
-      HistHit[i] = 1;
-      HistTot[i] = 1;
-   }
-
    // Code[]
 
    for (pos = 0; pos < CODE_SIZE; pos++) Code[pos] = GEN_ERROR;
@@ -166,31 +144,60 @@ void sort_init() {
    ASSERT(pos<CODE_SIZE);
 }
 
+// sort_clear()
+
+void sort_clear(search_t * search) {
+
+   int i, height;
+
+   ASSERT(search!=NULL);
+
+   // killer
+
+   for (height = 0; height < HeightMax; height++) {
+      for (i = 0; i < KillerNb; i++) search->killer[height][i] = MoveNone;
+   }
+
+   // history
+
+   for (i = 0; i < HistorySize; i++) search->history[i] = 0;
+
+   for (i = 0; i < HistorySize; i++) {
+      search->hist_hit[i] = 1;
+      search->hist_tot[i] = 1;
+   }
+}
+
 // sort_init()
 
-void sort_init(sort_t * sort, board_t * board, const attack_t * attack, int depth, int height, int trans_killer) {
+void sort_init(sort_t * sort, search_t * search, board_t * board, const attack_t * attack, int depth, int height, int trans_killer) {
 
    ASSERT(sort!=NULL);
+   ASSERT(search!=NULL);
    ASSERT(board!=NULL);
    ASSERT(attack!=NULL);
    ASSERT(depth_is_ok(depth));
    ASSERT(height_is_ok(height));
    ASSERT(trans_killer==MoveNone||move_is_ok(trans_killer));
 
+   sort->search = search;
    sort->board = board;
    sort->attack = attack;
 
    sort->depth = depth;
    sort->height = height;
 
+   sort->list = &search->list[height];
+   sort->bad = ListSize;
+
    sort->trans_killer = trans_killer;
-   sort->killer_1 = Killer[sort->height][0];
-   sort->killer_2 = Killer[sort->height][1];
+   sort->killer_1 = search->killer[sort->height][0];
+   sort->killer_2 = search->killer[sort->height][1];
 
    if (ATTACK_IN_CHECK(sort->attack)) {
 
       gen_legal_evasions(sort->list,sort->board,sort->attack);
-      note_moves(sort->list,sort->board,sort->height,sort->trans_killer);
+      note_moves(sort->search,sort->list,sort->board,sort->height,sort->trans_killer);
       list_sort(sort->list);
 
       sort->gen = PosLegalEvasion + 1;
@@ -211,6 +218,7 @@ int sort_next(sort_t * sort) {
 
    int move;
    int gen;
+   int size, i;
 
    ASSERT(sort!=NULL);
 
@@ -220,6 +228,14 @@ int sort_next(sort_t * sort) {
 
          // next move
 
+         if (UseSelection && (sort->test == TEST_GOOD_CAPTURE || sort->test == TEST_QUIET)) {
+            if (sort->pos < SelectNb) {
+               list_select(sort->list,sort->pos);
+            } else if (sort->pos == SelectNb) {
+               list_sort(sort->list); // no cut so far, the prefix is already in place
+            }
+         }
+
          move = LIST_MOVE(sort->list,sort->pos);
          sort->value = 16384; // default score
          sort->pos++;
@@ -246,7 +262,8 @@ int sort_next(sort_t * sort) {
             if (move == sort->trans_killer) continue;
 
             if (!capture_is_good(move,sort->board)) {
-               LIST_ADD(sort->bad,move);
+               ASSERT(sort->bad>LIST_SIZE(sort->list));
+               sort->list->move[--sort->bad] = move;
                continue;
             }
 
@@ -277,7 +294,7 @@ int sort_next(sort_t * sort) {
             if (move == sort->killer_2) continue;
             if (!pseudo_is_legal(move,sort->board)) continue;
 
-            sort->value = history_prob(move,sort->board);
+            sort->value = history_prob(sort->search,move,sort->board);
 
          } else {
 
@@ -308,15 +325,21 @@ int sort_next(sort_t * sort) {
 
          gen_captures(sort->list,sort->board);
          note_mvv_lva(sort->list,sort->board);
-         list_sort(sort->list);
+         if (!UseSelection) list_sort(sort->list);
 
-         LIST_CLEAR(sort->bad);
+         sort->bad = ListSize;
 
          sort->test = TEST_GOOD_CAPTURE;
 
       } else if (gen == GEN_BAD_CAPTURE) {
 
-         list_copy(sort->list,sort->bad);
+         // move the bad captures back to the front, in the order they were found
+
+         size = ListSize - sort->bad;
+         ASSERT(size<=sort->bad);
+
+         for (i = 0; i < size; i++) LIST_MOVE(sort->list,i) = LIST_MOVE(sort->list,ListSize-1-i);
+         sort->list->size = size;
 
          sort->test = TEST_BAD_CAPTURE;
 
@@ -331,8 +354,10 @@ int sort_next(sort_t * sort) {
       } else if (gen == GEN_QUIET) {
 
          gen_quiet_moves(sort->list,sort->board);
-         note_quiet_moves(sort->list,sort->board);
-         list_sort(sort->list);
+         note_quiet_moves(sort->search,sort->list,sort->board);
+         if (!UseSelection) list_sort(sort->list);
+
+         ASSERT(LIST_SIZE(sort->list)<=sort->bad); // bad captures still at the end
 
          sort->test = TEST_QUIET;
 
@@ -349,16 +374,21 @@ int sort_next(sort_t * sort) {
 
 // sort_init_qs()
 
-void sort_init_qs(sort_t * sort, board_t * board, const attack_t * attack, bool check) {
+void sort_init_qs(sort_t * sort, search_t * search, board_t * board, const attack_t * attack, int height, bool check) {
 
    ASSERT(sort!=NULL);
+   ASSERT(search!=NULL);
    ASSERT(board!=NULL);
    ASSERT(attack!=NULL);
+   ASSERT(height_is_ok(height));
    ASSERT(check==true||check==false);
 
+   sort->search = search;
    sort->board = board;
    sort->attack = attack;
 
+   sort->list = &search->list[height];
+
    if (ATTACK_IN_CHECK(sort->attack)) {
       sort->gen = PosEvasionQS;
    } else if (check) {
@@ -386,6 +416,14 @@ int sort_next_qs(sort_t * sort) {
 
          // next move
 
+         if (UseSelection && sort->test == TEST_CAPTURE_QS) {
+            if (sort->pos < SelectNb) {
+               list_select(sort->list,sort->pos);
+            } else if (sort->pos == SelectNb) {
+               list_sort(sort->list);
+            }
+         }
+
          move = LIST_MOVE(sort->list,sort->pos);
          sort->pos++;
 
@@ -444,7 +482,7 @@ int sort_next_qs(sort_t * sort) {
 
          gen_captures(sort->list,sort->board);
          note_mvv_lva(sort->list,sort->board);
-         list_sort(sort->list);
+         if (!UseSelection) list_sort(sort->list);
 
          sort->test = TEST_CAPTURE_QS;
 
@@ -467,11 +505,12 @@ int sort_next_qs(sort_t * sort) {
 
 // good_move()
 
-void good_move(int move, const board_t * board, int depth, int height) {
+void good_move(search_t * search, int move, const board_t * board, int depth, int height) {
 
    int index;
    int i;
 
+   ASSERT(search!=NULL);
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
    ASSERT(depth_is_ok(depth));
@@ -481,33 +520,34 @@ void good_move(int move, const board_t * board, int depth, int height) {
 
    // killer
 
-   if (Killer[height][0] != move) {
-      Killer[height][1] = Killer[height][0];
-      Killer[height][0] = move;
+   if (search->killer[height][0] != move) {
+      search->killer[height][1] = search->killer[height][0];
+      search->killer[height][0] = move;
    }
 
-   ASSERT(Killer[height][0]==move);
-   ASSERT(Killer[height][1]!=move);
+   ASSERT(search->killer[height][0]==move);
+   ASSERT(search->killer[height][1]!=move);
 
    // history
 
    index = history_index(move,board);
 
-   History[index] += HISTORY_INC(depth);
+   search->history[index] += HISTORY_INC(depth);
 
-   if (History[index] >= HistoryMax) {
+   if (search->history[index] >= HistoryMax) {
       for (i = 0; i < HistorySize; i++) {
-         History[i] = (History[i] + 1) / 2;
+         search->history[i] = (search->history[i] + 1) / 2;
       }
    }
 }
 
 // history_good()
 
-void history_good(int move, const board_t * board) {
+void history_good(search_t * search, int move, const board_t * board) {
 
    int index;
 
+   ASSERT(search!=NULL);
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
@@ -517,24 +557,25 @@ void history_good(int move, const board_t * board) {
 
    index = history_index(move,board);
 
-   HistHit[index]++;
-   HistTot[index]++;
+   search->hist_hit[index]++;
+   search->hist_tot[index]++;
 
-   if (HistTot[index] >= HistoryMax) {
-      HistHit[index] = (HistHit[index] + 1) / 2;
-      HistTot[index] = (HistTot[index] + 1) / 2;
+   if (search->hist_tot[index] >= HistoryMax) {
+      search->hist_hit[index] = (search->hist_hit[index] + 1) / 2;
+      search->hist_tot[index] = (search->hist_tot[index] + 1) / 2;
    }
 
-   ASSERT(HistHit[index]<=HistTot[index]);
-   ASSERT(HistTot[index]<HistoryMax);
+   ASSERT(search->hist_hit[index]<=search->hist_tot[index]);
+   ASSERT(search->hist_tot[index]<HistoryMax);
 }
 
 // history_bad()
 
-void history_bad(int move, const board_t * board) {
+void history_bad(search_t * search, int move, const board_t * board) {
 
    int index;
 
+   ASSERT(search!=NULL);
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
@@ -544,24 +585,25 @@ void history_bad(int move, const board_t * board) {
 
    index = history_index(move,board);
 
-   HistTot[index]++;
+   search->hist_tot[index]++;
 
-   if (HistTot[index] >= HistoryMax) {
-      HistHit[index] = (HistHit[index] + 1) / 2;
-      HistTot[index] = (HistTot[index] + 1) / 2;
+   if (search->hist_tot[index] >= HistoryMax) {
+      search->hist_hit[index] = (search->hist_hit[index] + 1) / 2;
+      search->hist_tot[index] = (search->hist_tot[index] + 1) / 2;
    }
 
-   ASSERT(HistHit[index]<=HistTot[index]);
-   ASSERT(HistTot[index]<HistoryMax);
+   ASSERT(search->hist_hit[index]<=search->hist_tot[index]);
+   ASSERT(search->hist_tot[index]<HistoryMax);
 }
 
 // note_moves()
 
-void note_moves(list_t * list, const board_t * board, int height, int trans_killer) {
+void note_moves(const search_t * search, list_t * list, const board_t * board, int height, int trans_killer) {
 
    int size;
    int i, move;
 
+   ASSERT(search!=NULL);
    ASSERT(list_is_ok(list));
    ASSERT(board!=NULL);
    ASSERT(height_is_ok(height));
@@ -572,7 +614,7 @@ void note_moves(list_t * list, const board_t * board, int height, int trans_kill
    if (size >= 2) {
       for (i = 0; i < size; i++) {
          move = LIST_MOVE(list,i);
-         list->value[i] = move_value(move,board,height,trans_killer);
+         list->value[i] = move_value(search,move,board,height,trans_killer);
       }
    }
 }
@@ -599,11 +641,12 @@ static void note_captures(list_t * list, const board_t * board) {
 
 // note_quiet_moves()
 
-static void note_quiet_moves(list_t * list, const board_t * board) {
+static void note_quiet_moves(const search_t * search, list_t * list, const board_t * board) {
 
    int size;
    int i, move;
 
+   ASSERT(search!=NULL);
    ASSERT(list_is_ok(list));
    ASSERT(board!=NULL);
 
@@ -612,7 +655,7 @@ static void note_quiet_moves(list_t * list, const board_t * board) {
    if (size >= 2) {
       for (i = 0; i < size; i++) {
          move = LIST_MOVE(list,i);
-         list->value[i] = quiet_move_value(move,board);
+         list->value[i] = quiet_move_value(search,move,board);
       }
    }
 }
@@ -659,10 +702,11 @@ static void note_mvv_lva(list_t * list, const board_t * board) {
 
 // move_value()
 
-static int move_value(int move, const board_t * board, int height, int trans_killer) {
+static int move_value(const search_t * search, int move, const board_t * board, int height, int trans_killer) {
 
    int value;
 
+   ASSERT(search!=NULL);
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
    ASSERT(height_is_ok(height));
@@ -673,12 +717,12 @@ static int move_value(int move, const board_t * board, int height, int trans_kil
       value = TransScore;
    } else if (move_is_tactical(move,board)) { // capture or promote
       value = capture_value(move,board);
-   } else if (move == Killer[height][0]) { // killer 1
+   } else if (move == search->killer[height][0]) { // killer 1
       value = KillerScore;
-   } else if (move == Killer[height][1]) { // killer 2
+   } else if (move == search->killer[height][1]) { // killer 2
       value = KillerScore - 1;
    } else { // quiet move
-      value = quiet_move_value(move,board);
+      value = quiet_move_value(search,move,board);
    }
 
    return value;
@@ -710,11 +754,12 @@ static int capture_value(int move, const board_t * board) {
 
 // quiet_move_value()
 
-static int quiet_move_value(int move, const board_t * board) {
+static int quiet_move_value(const search_t * search, int move, const board_t * board) {
 
    int value;
    int index;
 
+   ASSERT(search!=NULL);
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
@@ -722,7 +767,7 @@ static int quiet_move_value(int move, const board_t * board) {
 
    index = history_index(move,board);
 
-   value = HistoryScore + History[index];
+   value = HistoryScore + search->history[index];
    ASSERT(value>=HistoryScore&&value<=KillerScore-4);
 
    return value;
@@ -745,11 +790,12 @@ static int move_value_simple(int move, const board_t * board) {
 
 // history_prob()
 
-static int history_prob(int move, const board_t * board) {
+static int history_prob(const search_t * search, int move, const board_t * board) {
 
    int value;
    int index;
 
+   ASSERT(search!=NULL);
    ASSERT(move_is_ok(move));
    ASSERT(board!=NULL);
 
@@ -757,10 +803,10 @@ static int history_prob(int move, const board_t * board) {
 
    index = history_index(move,board);
 
-   ASSERT(HistHit[index]<=HistTot[index]);
-   ASSERT(HistTot[index]<HistoryMax);
+   ASSERT(search->hist_hit[index]<=search->hist_tot[index]);
+   ASSERT(search->hist_tot[index]<HistoryMax);
 
-   value = (HistHit[index] * 16384) / HistTot[index];
+   value = (search->hist_hit[index] * 16384) / search->hist_tot[index];
    ASSERT(value>=0&&value<=16384);
 
    return value;
@@ -9,6 +9,7 @@
 #include "attack.h"
 #include "board.h"
 #include "list.h"
+#include "search.h"
 #include "util.h"
 
 // types
@@ -23,28 +24,30 @@ struct sort_t {
    int test;
    int pos;
    int value;
+   int bad; // bad captures are kept at the end of the list, from ListSize down
    board_t * board;
    const attack_t * attack;
-   list_t list[1];
-   list_t bad[1];
+   list_t * list; // per-thread buffer for this height
+   search_t * search;
 };
 
 // functions
 
 extern void sort_init    ();
+extern void sort_clear   (search_t * search);
 
-extern void sort_init    (sort_t * sort, board_t * board, const attack_t * attack, int depth, int height, int trans_killer);
+extern void sort_init    (sort_t * sort, search_t * search, board_t * board, const attack_t * attack, int depth, int height, int trans_killer);
 extern int  sort_next    (sort_t * sort);
 
-extern void sort_init_qs (sort_t * sort, board_t * board, const attack_t * attack, bool check);
+extern void sort_init_qs (sort_t * sort, search_t * search, board_t * board, const attack_t * attack, int height, bool check);
 extern int  sort_next_qs (sort_t * sort);
 
-extern void good_move    (int move, const board_t * board, int depth, int height);
+extern void good_move    (search_t * search, int move, const board_t * board, int depth, int height);
 
-extern void history_good (int move, const board_t * board);
-extern void history_bad  (int move, const board_t * board);
+extern void history_good (search_t * search, int move, const board_t * board);
+extern void history_bad  (search_t * search, int move, const board_t * board);
 
-extern void note_moves   (list_t * list, const board_t * board, int height, int trans_killer);
+extern void note_moves   (const search_t * search, list_t * list, const board_t * board, int height, int trans_killer);
 
 #endif // !defined SORT_H
 
@@ -3,9 +3,12 @@
 
 // includes
 
+#include <atomic>
+
 #include "hash.h"
 #include "move.h"
 #include "option.h"
+#include "posix.h"
 #include "protocol.h"
 #include "trans.h"
 #include "util.h"
@@ -24,10 +27,18 @@ static const int DateSize = 16;
 
 static const int ClusterSize = 4; // TODO: unsigned?
 
+static const int CacheLineSize = 64; // one cluster per line
+
 static const int DepthNone = -128;
 
+static const int StatSize = 1000; // entries sampled for "hashfull"
+
 // types
 
+// entry_t is the unpacked form of an entry, packed_t is how it is stored.
+// The lock is XOR-ed with the rest of the entry so that a reader that sees
+// the two words from two different writes gets a wrong lock (i.e. a miss).
+
 struct entry_t {
    uint32 lock;
    uint16 move;
@@ -41,18 +52,17 @@ struct entry_t {
    sint16 max_value;
 };
 
+struct packed_t {
+   std::atomic<uint64> data_1; // lock ^ rest, date, depth, min_depth, max_depth
+   std::atomic<uint64> data_2; // move, min_value, max_value, move_depth, flags
+};
+
 struct trans { // HACK: typedef'ed in trans.h
-   entry_t * table;
-   uint32 size;
-   uint32 mask;
+   packed_t * table;
+   uint64 size;
+   uint64 mask;
    int date;
    int age[DateSize];
-   uint32 used;
-   sint64 read_nb;
-   sint64 read_hit;
-   sint64 write_nb;
-   sint64 write_hit;
-   sint64 write_collision;
 };
 
 // variables
@@ -61,12 +71,15 @@ trans_t Trans[1];
 
 // prototypes
 
-static void      trans_set_date (trans_t * trans, int date);
-static int       trans_age      (const trans_t * trans, int date);
+static void       trans_set_date (trans_t * trans, int date);
+static int        trans_age      (const trans_t * trans, int date);
+
+static packed_t * trans_entry    (const trans_t * trans, uint64 key);
 
-static entry_t * trans_entry    (trans_t * trans, uint64 key);
+static bool       entry_is_ok    (const entry_t * entry);
 
-static bool      entry_is_ok    (const entry_t * entry);
+static void       entry_read     (entry_t * entry, const packed_t * packed);
+static void       entry_write    (packed_t * packed, const entry_t * entry);
 
 // functions
 
@@ -96,7 +109,8 @@ void trans_init(trans_t * trans) {
 
    ASSERT(trans!=NULL);
 
-   ASSERT(sizeof(entry_t)==16);
+   ASSERT(sizeof(packed_t)==16);
+   ASSERT(ClusterSize*sizeof(packed_t)==CacheLineSize);
 
    trans->size = 0;
    trans->mask = 0;
@@ -110,19 +124,41 @@ void trans_init(trans_t * trans) {
 }
 
 // trans_alloc()
+
 void trans_alloc(trans_t * trans) {
-   uint32 size = 2 * 1024 * 1024;
-   size /= sizeof(entry_t);
 
-   // Need to investigate if this is really necessary. Note the "HACK" below.
+   uint64 size, target;
+
+   ASSERT(trans!=NULL);
+
+   // calculate size
+
+   target = option_get_int("Hash");
+   if (target < 4) target = 16;
+   target *= 1024 * 1024;
+
+   for (size = 1; size != 0 && size <= target; size *= 2)
+      ;
+
+   size /= 2;
+   ASSERT(size>0&&size<=target);
+
+   // allocate table
+
+   size /= sizeof(packed_t); // the table holds packed entries
    ASSERT(size!=0&&(size&(size-1))==0); // power of 2
 
-   trans->size = size + (ClusterSize - 1); // HACK to avoid testing for end of table
-   trans->mask = size - 1;
+   ASSERT(size>=ClusterSize);
 
-   trans->table = (entry_t *) my_malloc(trans->size*sizeof(entry_t));
+   trans->size = size;
+   trans->mask = size / ClusterSize - 1; // clusters do not overlap
+
+   trans->table = (packed_t *) large_alloc(trans->size*sizeof(packed_t));
+   ASSERT((size_t(trans->table)&(CacheLineSize-1))==0);
 
    trans_clear(trans);
+
+   ASSERT(trans_is_ok(trans));
 }
 
 // trans_free()
@@ -131,7 +167,7 @@ void trans_free(trans_t * trans) {
 
    ASSERT(trans_is_ok(trans));
 
-   my_free(trans->table);
+   large_free(trans->table,trans->size*sizeof(packed_t));
 
    trans->table = NULL;
    trans->size = 0;
@@ -143,8 +179,8 @@ void trans_free(trans_t * trans) {
 void trans_clear(trans_t * trans) {
 
    entry_t clear_entry[1];
-   entry_t * entry;
-   uint32 index;
+   packed_t * packed;
+   uint64 index;
 
    ASSERT(trans!=NULL);
 
@@ -163,10 +199,10 @@ void trans_clear(trans_t * trans) {
 
    ASSERT(entry_is_ok(clear_entry));
 
-   entry = trans->table;
+   packed = trans->table;
 
    for (index = 0; index < trans->size; index++) {
-      *entry++ = *clear_entry;
+      entry_write(packed++,clear_entry);
    }
 }
 
@@ -191,13 +227,6 @@ static void trans_set_date(trans_t * trans, int date) {
    for (date = 0; date < DateSize; date++) {
       trans->age[date] = trans_age(trans,date);
    }
-
-   trans->used = 0;
-   trans->read_nb = 0;
-   trans->read_hit = 0;
-   trans->write_nb = 0;
-   trans->write_hit = 0;
-   trans->write_collision = 0;
 }
 
 // trans_age()
@@ -221,7 +250,8 @@ static int trans_age(const trans_t * trans, int date) {
 
 void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value, int max_value) {
 
-   entry_t * entry, * best_entry;
+   packed_t * packed, * best_packed;
+   entry_t entry[1];
    int score, best_score;
    int i;
 
@@ -232,26 +262,21 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
    ASSERT(max_value>=-ValueInf&&max_value<=+ValueInf);
    ASSERT(min_value<=max_value);
 
-   // init
-
-   trans->write_nb++;
-
    // probe
 
-   best_entry = NULL;
+   best_packed = NULL;
    best_score = -32767;
 
-   entry = trans_entry(trans,key);
+   packed = trans_entry(trans,key);
+
+   for (i = 0; i < ClusterSize; i++, packed++) {
 
-   for (i = 0; i < ClusterSize; i++, entry++) {
+      entry_read(entry,packed);
 
       if (entry->lock == KEY_LOCK(key)) {
 
          // hash hit => update existing entry
 
-         trans->write_hit++;
-         if (entry->date != trans->date) trans->used++;
-
          entry->date = trans->date;
 
          if (depth > entry->depth) entry->depth = depth; // for replacement scheme
@@ -273,6 +298,8 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
 
          ASSERT(entry_is_ok(entry));
 
+         entry_write(packed,entry);
+
          return;
       }
 
@@ -282,27 +309,18 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
       ASSERT(score>-32767);
 
       if (score > best_score) {
-         best_entry = entry;
+         best_packed = packed;
          best_score = score;
       }
    }
 
    // "best" entry found
 
-   entry = best_entry;
-   ASSERT(entry!=NULL);
-   ASSERT(entry->lock!=KEY_LOCK(key));
-
-   if (entry->date == trans->date) {
-      trans->write_collision++;
-   } else {
-      trans->used++;
-   }
+   packed = best_packed;
+   ASSERT(packed!=NULL);
 
    // store
 
-   ASSERT(entry!=NULL);
-
    entry->lock = KEY_LOCK(key);
    entry->date = trans->date;
 
@@ -311,19 +329,24 @@ void trans_store(trans_t * trans, uint64 key, int move, int depth, int min_value
    entry->move_depth = (move != MoveNone) ? depth : DepthNone;
    entry->move = move;
 
+   entry->flags = 0;
+
    entry->min_depth = (min_value > -ValueInf) ? depth : DepthNone;
    entry->max_depth = (max_value < +ValueInf) ? depth : DepthNone;
    entry->min_value = min_value;
    entry->max_value = max_value;
 
    ASSERT(entry_is_ok(entry));
+
+   entry_write(packed,entry);
 }
 
 // trans_retrieve()
 
 bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, int * max_depth, int * min_value, int * max_value) {
 
-   entry_t * entry;
+   packed_t * packed;
+   entry_t entry[1];
    int i;
 
    ASSERT(trans_is_ok(trans));
@@ -333,22 +356,24 @@ bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, in
    ASSERT(min_value!=NULL);
    ASSERT(max_value!=NULL);
 
-   // init
-
-   trans->read_nb++;
-
    // probe
 
-   entry = trans_entry(trans,key);
+   packed = trans_entry(trans,key);
+
+   for (i = 0; i < ClusterSize; i++, packed++) {
 
-   for (i = 0; i < ClusterSize; i++, entry++) {
+      entry_read(entry,packed);
 
       if (entry->lock == KEY_LOCK(key)) {
 
          // found
 
-         trans->read_hit++;
-         if (entry->date != trans->date) entry->date = trans->date;
+         ASSERT(entry_is_ok(entry));
+
+         if (entry->date != trans->date) {
+            entry->date = trans->date;
+            entry_write(packed,entry);
+         }
 
          *move = entry->move;
 
@@ -366,39 +391,64 @@ bool trans_retrieve(trans_t * trans, uint64 key, int * move, int * min_depth, in
    return false;
 }
 
+// trans_prefetch()
+
+void trans_prefetch(const trans_t * trans, uint64 key) {
+
+   ASSERT(trans!=NULL);
+
+   if (trans->table == NULL) return; // not allocated yet
+
+   PREFETCH(trans_entry(trans,key));
+}
+
 // trans_stats()
 
 void trans_stats(const trans_t * trans) {
 
+   entry_t entry[1];
+   uint64 size, index;
+   int used;
    double full;
-   // double hit, collision;
 
    ASSERT(trans_is_ok(trans));
 
-   full = double(trans->used) / double(trans->size);
-   // hit = double(trans->read_hit) / double(trans->read_nb);
-   // collision = double(trans->write_collision) / double(trans->write_nb);
+   // sample the start of the table, the threads do not count writes
+
+   size = StatSize;
+   if (size > trans->size) size = trans->size;
+
+   used = 0;
+
+   for (index = 0; index < size; index++) {
+      entry_read(entry,&trans->table[index]);
+      if (entry->date == trans->date && entry->depth != DepthNone) used++;
+   }
+
+   full = double(used) / double(size);
 
    send("info hashfull %.0f",full*1000.0);
 }
 
 // trans_entry()
 
-static entry_t * trans_entry(trans_t * trans, uint64 key) {
+static packed_t * trans_entry(const trans_t * trans, uint64 key) {
 
-   uint32 index;
+   uint64 index;
 
    ASSERT(trans_is_ok(trans));
 
+   // use the full key so that tables above 2^32 clusters are indexed entirely
+
    if (UseModulo) {
-      index = KEY_INDEX(key) % (trans->mask + 1);
+      index = key % (trans->mask + 1);
    } else {
-      index = KEY_INDEX(key) & trans->mask;
+      index = key & trans->mask;
    }
 
    ASSERT(index<=trans->mask);
 
-   return &trans->table[index];
+   return &trans->table[index*ClusterSize]; // one cache line per cluster
 }
 
 // entry_is_ok()
@@ -421,5 +471,57 @@ static bool entry_is_ok(const entry_t * entry) {
    return true;
 }
 
+// entry_read()
+
+static void entry_read(entry_t * entry, const packed_t * packed) {
+
+   uint64 data_1, data_2;
+
+   ASSERT(entry!=NULL);
+   ASSERT(packed!=NULL);
+
+   data_1 = packed->data_1.load(std::memory_order_relaxed);
+   data_2 = packed->data_2.load(std::memory_order_relaxed);
+
+   entry->lock = uint32(data_1) ^ uint32(data_1>>32) ^ uint32(data_2) ^ uint32(data_2>>32);
+
+   entry->date = uint8(data_1>>32);
+   entry->depth = sint8(data_1>>40);
+   entry->min_depth = sint8(data_1>>48);
+   entry->max_depth = sint8(data_1>>56);
+
+   entry->move = uint16(data_2);
+   entry->min_value = sint16(data_2>>16);
+   entry->max_value = sint16(data_2>>32);
+   entry->move_depth = sint8(data_2>>48);
+   entry->flags = uint8(data_2>>56);
+}
+
+// entry_write()
+
+static void entry_write(packed_t * packed, const entry_t * entry) {
+
+   uint64 data_1, data_2;
+
+   ASSERT(packed!=NULL);
+   ASSERT(entry_is_ok(entry));
+
+   data_1 = (uint64(entry->date) << 32)
+          | (uint64(uint8(entry->depth)) << 40)
+          | (uint64(uint8(entry->min_depth)) << 48)
+          | (uint64(uint8(entry->max_depth)) << 56);
+
+   data_2 = uint64(entry->move)
+          | (uint64(uint16(entry->min_value)) << 16)
+          | (uint64(uint16(entry->max_value)) << 32)
+          | (uint64(uint8(entry->move_depth)) << 48)
+          | (uint64(entry->flags) << 56);
+
+   data_1 |= entry->lock ^ uint32(data_1>>32) ^ uint32(data_2) ^ uint32(data_2>>32);
+
+   packed->data_2.store(data_2,std::memory_order_relaxed);
+   packed->data_1.store(data_1,std::memory_order_relaxed);
+}
+
 // end of trans.cpp
 
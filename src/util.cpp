@@ -65,7 +65,7 @@ int my_round(double x) {
 
 // my_malloc()
 
-void * my_malloc(int size) {
+void * my_malloc(size_t size) {
 
    void * address;
 
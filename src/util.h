@@ -8,6 +8,10 @@
 
 #include <cstdio>
 
+#ifdef _MSC_VER
+#  include <xmmintrin.h>
+#endif
+
 // constants
 
 #undef FALSE
@@ -41,6 +45,14 @@
 #  define U64(u) (u##ULL)
 #endif
 
+#if defined(__GNUC__)
+#  define PREFETCH(a) __builtin_prefetch(a)
+#elif defined(_MSC_VER)
+#  define PREFETCH(a) _mm_prefetch((const char *)(a),_MM_HINT_T0)
+#else
+#  define PREFETCH(a)
+#endif
+
 #undef ASSERT
 #if DEBUG
 #  define ASSERT(a) { if (!(a)) my_fatal("file \"%s\", line %d, assertion \"" #a "\" failed\n",__FILE__,__LINE__); }
@@ -86,7 +98,7 @@ extern sint64 my_atoll              (const char string[]);
 
 extern int    my_round              (double x);
 
-extern void * my_malloc             (int size);
+extern void * my_malloc             (size_t size);
 extern void   my_free               (void * address);
 
 extern void   my_fatal              (const char format[], ...);